@@ -0,0 +1,278 @@
+/*******************************************************************************
+ * Runs the workload corpus in bench.h against each implementation, and prints
+ * a table of nanoseconds per call, throughput, and hardware counts per call:
+ * instructions, cycles, branch misses, L1d misses and divider-busy cycles.
+ * Counters the system won't allow show as "-".
+ *
+ * Usage:  bench [-j] [-t ms] [-r reps] [-c cpu] [-w workload] [-i impl]
+ *
+ *  -- "-j" prints JSON instead of a table, for tracking trends.  Counters
+ *     that are unavailable are null.
+ *
+ *  -- "-t" sets the target time of each timed run (default 20 ms).
+ *  -- "-r" sets how many timed runs to take the median of (default 5).
+ *  -- "-c" pins the runs to a CPU (default: the one it starts on).
+ *  -- "-w" and "-i" limit the runs to one workload or implementation.
+ *
+ * Each workload runs two ways:  "buf" prints into a buffer, like snprintf(),
+ * and "stream" prints to stdout, like printf().  For the stream runs, stdout
+ * points at a sink that counts bytes and discards them, so the runs measure
+ * formatting and stdio, not the kernel.
+ *
+ * ____________________________________________________________________________
+ *  Copyright © 2023, J. Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  Author:  Joe Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  SPDX-License-Identifier:  CC-BY-SA-4.0
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "counters.h"
+#include "harness.h"
+#include "sink.h"
+
+/*******************************************************************************
+ * Timing
+ ******************************************************************************/
+
+/* Results of running one workload on one implementation, one way. */
+struct measurement {
+  double ns_per_call;
+  double bytes_per_call;
+  double per_call[kNumCounters];  /* Counts per call, or negative if none. */
+};
+
+/* Runs a workload n times, one way or the other.  Returns the bytes output. */
+static uint64_t run(bench_buf_runner *buf_runner,
+                    bench_stream_runner *stream_runner, unsigned n) {
+  static char buf[BENCH_BUF_SIZE];
+
+  if (buf_runner) { return buf_runner(buf, sizeof(buf), 0, n); }
+
+  const uint64_t before = sink_bytes;
+  stream_runner(0, n);
+  fflush(stdout);
+  return sink_bytes - before;
+}
+
+/*
+ * Measures one runner.  The iteration count doubles until a run takes the
+ * target time.  Then each of the timed runs uses that count, and the results
+ * are the medians across them.
+ */
+#define MAX_REPS 101
+
+static void measure(bench_buf_runner *buf_runner,
+                    bench_stream_runner *stream_runner,
+                    struct counters *ctrs, double target_ns, int reps,
+                    struct measurement *m) {
+  unsigned n = 1;
+  while (n < UINT32_MAX / 2) {
+    const double start = now_ns();
+    run(buf_runner, stream_runner, n);
+    if (now_ns() - start >= target_ns) { break; }
+    n *= 2;
+  }
+
+  double ns[MAX_REPS], bytes[MAX_REPS], counts[kNumCounters][MAX_REPS];
+  bool have[kNumCounters];
+  for (int c = 0; c < kNumCounters; c++) { have[c] = true; }
+
+  for (int r = 0; r < reps; r++) {
+    uint64_t values[kNumCounters];
+    bool valid[kNumCounters];
+    counters_start(ctrs);
+    const double start = now_ns();
+    const uint64_t total = run(buf_runner, stream_runner, n);
+    const double end = now_ns();
+    counters_stop(ctrs, values, valid);
+
+    ns[r] = (end - start) / n;
+    bytes[r] = (double)total / n;
+    for (int c = 0; c < kNumCounters; c++) {
+      have[c] &= valid[c];
+      counts[c][r] = (double)values[c] / n;
+    }
+  }
+
+  struct sample_stats stats;
+  summarize(ns, reps, &stats);
+  m->ns_per_call = stats.median;
+  summarize(bytes, reps, &stats);
+  m->bytes_per_call = stats.median;
+  for (int c = 0; c < kNumCounters; c++) {
+    summarize(counts[c], reps, &stats);
+    m->per_call[c] = have[c] ? stats.median : -1;
+  }
+}
+
+
+/*******************************************************************************
+ * Reporting, as a table or JSON
+ ******************************************************************************/
+
+/* Counters in the order of the table's columns, and their headings. */
+static const struct { int counter; const char *heading; } columns[] = {
+  { kCounterInsns,        "insns"    },
+  { kCounterCycles,       "cycles"   },
+  { kCounterBranchMisses, "br-miss"  },
+  { kCounterL1dMisses,    "l1d-miss" },
+  { kCounterDivActive,    "div-cyc"  },
+};
+
+#define NUM_COLUMNS (sizeof(columns) / sizeof(columns[0]))
+
+static void print_table_header(FILE *out) {
+  fprintf(out, "%-12s %-6s %-5s %10s %10s",
+          "workload", "mode", "impl", "ns/call", "MB/s");
+  for (size_t c = 0; c < NUM_COLUMNS; c++) {
+    fprintf(out, " %9s", columns[c].heading);
+  }
+  fprintf(out, "\n");
+}
+
+static void print_table_row(FILE *out, const char *workload, const char *mode,
+                            const char *impl, const struct measurement *m) {
+  fprintf(out, "%-12s %-6s %-5s %10.1f %10.1f", workload, mode, impl,
+          m->ns_per_call, m->bytes_per_call * 1e3 / m->ns_per_call);
+  for (size_t c = 0; c < NUM_COLUMNS; c++) {
+    const double val = m->per_call[columns[c].counter];
+    if (val >= 0) {
+      fprintf(out, " %9.*f", val < 10 ? 2 : 0, val);
+    } else {
+      fprintf(out, " %9s", "-");
+    }
+  }
+  fprintf(out, "\n");
+}
+
+static void print_json_header(FILE *out, int cpu, double target_ms, int reps) {
+  fprintf(out, "{\n  \"cpu\": %d,\n  \"target_ms\": %g,\n  \"reps\": %d,\n"
+               "  \"results\": [", cpu, target_ms, reps);
+}
+
+static void print_json_row(FILE *out, bool first, const char *workload,
+                           const char *mode, const char *impl,
+                           const struct measurement *m) {
+  fprintf(out, "%s\n    {\"workload\": \"%s\", \"mode\": \"%s\", "
+               "\"impl\": \"%s\",\n     \"ns_per_call\": %.3f, "
+               "\"bytes_per_call\": %.3f,\n     \"per_call\": {",
+          first ? "" : ",", workload, mode, impl,
+          m->ns_per_call, m->bytes_per_call);
+  for (int c = 0; c < kNumCounters; c++) {
+    fprintf(out, "%s\"%s\": ", c ? ", " : "", counter_names[c]);
+    if (m->per_call[c] >= 0) {
+      fprintf(out, "%.3f", m->per_call[c]);
+    } else {
+      fprintf(out, "null");
+    }
+  }
+  fprintf(out, "}}");
+}
+
+static void print_json_footer(FILE *out) {
+  fprintf(out, "\n  ]\n}\n");
+}
+
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "Usage: %s [-j] [-t ms] [-r reps] [-c cpu] [-w workload] "
+                  "[-i impl]\n", argv0);
+  exit(2);
+}
+
+int main(int argc, char *argv[]) {
+  double target_ms = 20;
+  int reps = 5, cpu = -1;
+  bool json = false;
+  const char *only_workload = NULL, *only_impl = NULL;
+
+  for (int opt; (opt = getopt(argc, argv, "jt:r:c:w:i:")) != -1;) {
+    switch (opt) {
+      case 'j': { json = true;                   break; }
+      case 't': { target_ms = atof(optarg);      break; }
+      case 'r': { reps = atoi(optarg);           break; }
+      case 'c': { cpu = atoi(optarg);            break; }
+      case 'w': { only_workload = optarg;        break; }
+      case 'i': { only_impl = optarg;            break; }
+      default:  { usage(argv[0]); }
+    }
+  }
+
+  if (target_ms <= 0 || reps < 1 || reps > MAX_REPS) { usage(argv[0]); }
+
+  /* Results go to the real stdout, and stream runs go to the sink. */
+  FILE *const out = stdout;
+  FILE *const sink = sink_open();
+  if (!sink) { perror("fopencookie"); return 1; }
+  stdout = sink;
+
+  cpu = pin_to_cpu(cpu);
+  if (cpu < 0) { fprintf(stderr, "Couldn't pin to a CPU.\n"); }
+
+  struct counters ctrs;
+  if (counters_open(&ctrs) < kNumCounters) {
+    fprintf(stderr, "Counters unavailable:");
+    for (int c = 0; c < kNumCounters; c++) {
+      if (ctrs.fd[c] < 0) { fprintf(stderr, " %s", counter_names[c]); }
+    }
+    fprintf(stderr, ".  See /proc/sys/kernel/perf_event_paranoid.\n");
+  }
+
+  if (json) {
+    print_json_header(out, cpu, target_ms, reps);
+  } else {
+    print_table_header(out);
+  }
+
+  bool first = true;
+
+  for (size_t w = 0; w < BENCH_NUM_WORKLOADS; w++) {
+    const struct bench_workload *const wl = &bench_workloads[w];
+    if (only_workload && strcmp(only_workload, wl->name)) { continue; }
+
+    for (int mode = 0; mode < 2; mode++) {
+      for (size_t i = 0; i < BENCH_NUM_IMPLS; i++) {
+        const struct bench_impl *impl = bench_impls[i];
+        if (only_impl && strcmp(only_impl, impl->name)) { continue; }
+        if (!bench_supports(impl, wl)) { continue; }
+
+        bench_buf_runner *const buf_runner =
+            mode == 0 && impl->buf_runners ? impl->buf_runners[w] : NULL;
+        bench_stream_runner *const stream_runner =
+            mode == 1 && impl->stream_runners ? impl->stream_runners[w] : NULL;
+        if (!buf_runner && !stream_runner) { continue; }
+
+        struct measurement m;
+        measure(buf_runner, stream_runner, &ctrs, target_ms * 1e6, reps, &m);
+
+        const char *const mode_name = mode == 0 ? "buf" : "stream";
+        if (json) {
+          print_json_row(out, first, wl->name, mode_name,
+                         impl->name, &m);
+        } else {
+          print_table_row(out, wl->name, mode_name,
+                          impl->name, &m);
+        }
+        first = false;
+        fflush(out);
+      }
+    }
+  }
+
+  if (json) { print_json_footer(out); }
+
+  counters_close(&ctrs);
+  stdout = out;
+  fclose(sink);
+  return 0;
+}
@@ -0,0 +1,166 @@
+/*******************************************************************************
+ * Benchmark harness for the simple_printf versions, alongside the C library.
+ *
+ * Each implementation gets its own translation unit (impl_*.c), which pulls
+ * in that version's source file with its public names renamed, so they can
+ * all link into one program.  Each one expands BENCH_WORKLOADS into a set of
+ * runners, one per workload, for each way it can print:
+ *
+ *  -- Into a buffer, like snprintf().
+ *  -- To stdout, like printf(), which bench.c points at a counting sink.
+ *
+ * A runner formats its workload n times, with iteration numbers starting at
+ * first.
+ *
+ * ____________________________________________________________________________
+ *  Copyright © 2023, J. Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  Author:  Joe Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  SPDX-License-Identifier:  CC-BY-SA-4.0
+ ******************************************************************************/
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Size of the buffer the snprintf-style runners print into. */
+#define BENCH_BUF_SIZE 8192
+
+/* Arguments the workloads draw from. */
+extern const char *const  bench_words[8];
+extern const char *const  bench_fields[4];
+extern const unsigned char bench_ipv4[4];
+extern const unsigned char bench_ipv6[16];
+extern const unsigned char bench_mac[6];
+
+#define BENCH_WORD(i) (bench_words[(i) & 7])
+
+/* The nth 16-bit group of bench_ipv6, and the nth byte of bench_mac. */
+#define BENCH_IPV6_GROUP(n)                                                    \
+  ((unsigned)bench_ipv6[2 * (n)] << 8 | bench_ipv6[2 * (n) + 1])
+#define BENCH_MAC(n) ((unsigned)bench_mac[n])
+
+/*
+ * Quotes a CSV field the way %Q does, into a per-thread buffer, one per slot
+ * (0 to 2), so one call can pass several.  Fields must be short.
+ */
+const char *bench_csv_field(int slot, const char *field);
+
+/*
+ * The workload corpus:  X(name, since, libc, format, args...).  "since" is
+ * the first simple_printf version that supports the format, and "libc" says
+ * whether the C library does.  Arguments vary with the iteration number i,
+ * an unsigned, so nothing folds away.
+ *
+ * The *_base workloads print the same thing as the workload before them the
+ * way a caller would without the v8 conversion:  csv_base quotes each field
+ * into a temporary buffer and prints it with %s, and net_base prints each
+ * byte or group with its own conversion.  net_base doesn't compress runs of
+ * zero groups in the IPv6 address, as %lI does.
+ */
+#define BENCH_WORKLOADS(X)                                                     \
+  X(integer,     5, true,  "%d %u %x %ld %llu\n",                              \
+    -7 * (int)i, i, i * 2654435761u, 1000003L * (long)i,                       \
+    (unsigned long long)i << 35)                                               \
+  X(string,      5, true,  "%s %s %s %s\n",                                    \
+    BENCH_WORD(i), BENCH_WORD(i + 1), BENCH_WORD(i + 2), BENCH_WORD(i + 3))    \
+  X(padding,     5, true,  "[%-16s|%10d|%08x|%12s]\n",                         \
+    BENCH_WORD(i), (int)i, i, BENCH_WORD(i + 5))                               \
+  X(literal,     5, true,  "The quick brown fox jumps over the lazy dog; "     \
+                           "pack my box with five dozen liquor jugs: %u\n", i) \
+  X(large_width, 5, true,  "%5000s|%-3000u\n", "x", i)                         \
+  X(csv,         8, false, "%Q,%Q,%u,%Q\n",                                    \
+    BENCH_WORD(i), bench_fields[i & 3], i, BENCH_WORD(i + 2))                  \
+  X(csv_base,    5, true,  "%s,%s,%u,%s\n",                                    \
+    bench_csv_field(0, BENCH_WORD(i)),                                         \
+    bench_csv_field(1, bench_fields[i & 3]), i,                                \
+    bench_csv_field(2, BENCH_WORD(i + 2)))                                     \
+  X(network,     8, false, "%I %lI %M\n", bench_ipv4, bench_ipv6, bench_mac)   \
+  X(net_base,    5, true,  "%u.%u.%u.%u %x:%x:%x:%x:%x:%x:%x:%x "              \
+                           "%02x:%02x:%02x:%02x:%02x:%02x\n",                  \
+    bench_ipv4[0], bench_ipv4[1], bench_ipv4[2], bench_ipv4[3],                \
+    BENCH_IPV6_GROUP(0), BENCH_IPV6_GROUP(1), BENCH_IPV6_GROUP(2),             \
+    BENCH_IPV6_GROUP(3), BENCH_IPV6_GROUP(4), BENCH_IPV6_GROUP(5),             \
+    BENCH_IPV6_GROUP(6), BENCH_IPV6_GROUP(7),                                  \
+    BENCH_MAC(0), BENCH_MAC(1), BENCH_MAC(2), BENCH_MAC(3), BENCH_MAC(4),      \
+    BENCH_MAC(5))
+
+/*
+ * Formats a workload n times, for iterations first through first + n - 1.
+ * Buffer runners return the bytes produced.
+ */
+typedef size_t bench_buf_runner(char *buf, size_t size, unsigned first,
+                                unsigned n);
+typedef void   bench_stream_runner(unsigned first, unsigned n);
+
+/* One implementation to measure.  Either set of runners may be NULL. */
+struct bench_impl {
+  const char           *name;
+  int                   version;         /* simple_printf version, or 0.  */
+  bench_buf_runner    *const *buf_runners;
+  bench_stream_runner *const *stream_runners;
+};
+
+/* Defines buf_runners[], calling BENCH_SNPRINTF(buf, size, fmt, ...). */
+#define BENCH_BUF_RUNNER_(name, since, libc, fmt, ...)                         \
+  static size_t name##_buf(char *buf, size_t size, unsigned first,            \
+                           unsigned n) {                                       \
+    size_t bytes = 0;                                                          \
+    for (unsigned i = first; i != first + n; i++) {                            \
+      bytes += BENCH_SNPRINTF(buf, size, fmt, __VA_ARGS__);                    \
+    }                                                                          \
+    return bytes;                                                              \
+  }
+#define BENCH_BUF_ENTRY_(name, ...) name##_buf,
+
+#define BENCH_DEFINE_BUF_RUNNERS                                               \
+  BENCH_WORKLOADS(BENCH_BUF_RUNNER_)                                           \
+  static bench_buf_runner *const buf_runners[] = {                             \
+    BENCH_WORKLOADS(BENCH_BUF_ENTRY_)                                          \
+  };
+
+/*
+ * Defines stream_runners[], calling BENCH_PRINTF(fmt, ...).  Not every
+ * version returns a length, so bench.c counts the bytes at the sink.
+ */
+#define BENCH_STREAM_RUNNER_(name, since, libc, fmt, ...)                      \
+  static void name##_stream(unsigned first, unsigned n) {                      \
+    for (unsigned i = first; i != first + n; i++) {                            \
+      (void)BENCH_PRINTF(fmt, __VA_ARGS__);                                    \
+    }                                                                          \
+  }
+#define BENCH_STREAM_ENTRY_(name, ...) name##_stream,
+
+#define BENCH_DEFINE_STREAM_RUNNERS                                            \
+  BENCH_WORKLOADS(BENCH_STREAM_RUNNER_)                                        \
+  static bench_stream_runner *const stream_runners[] = {                       \
+    BENCH_WORKLOADS(BENCH_STREAM_ENTRY_)                                       \
+  };
+
+/* The implementations, from impl_*.c. */
+extern const struct bench_impl bench_libc;
+extern const struct bench_impl bench_v5;
+extern const struct bench_impl bench_v6;
+extern const struct bench_impl bench_v7;
+extern const struct bench_impl bench_v8;
+
+/* Descriptions of the workloads, from workloads.c, in BENCH_WORKLOADS order. */
+struct bench_workload {
+  const char *name;
+  int         since;  /* First simple_printf version that supports it. */
+  bool        libc;   /* True if the C library supports it.           */
+};
+
+#define BENCH_COUNT_(...) +1
+#define BENCH_NUM_WORKLOADS (0 BENCH_WORKLOADS(BENCH_COUNT_))
+#define BENCH_NUM_IMPLS     5
+
+extern const struct bench_workload   bench_workloads[BENCH_NUM_WORKLOADS];
+extern const struct bench_impl *const bench_impls[BENCH_NUM_IMPLS];
+
+/* Returns true if impl can print the workload. */
+bool bench_supports(const struct bench_impl *impl,
+                    const struct bench_workload *w);
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,205 @@
+/*******************************************************************************
+ * Counts the stdio calls and write()s each implementation makes per formatted
+ * line, under each kind of stdio buffering.
+ *
+ * Stdio calls are counted by wrapping fwrite(), fputc(), putc(), and the rest
+ * at link time (see the Makefile), so every call an implementation makes into
+ * stdio goes through a counter here.  The C library's own printf() counts as
+ * one call.  write()s are counted at the sink:  each time stdio flushes to
+ * it is a place a FILE on a file descriptor would make a write() system call.
+ *
+ * Usage:  calls [-n lines] [-c] [-w workload] [-i impl]
+ *
+ *  -- "-n" sets how many lines to format in each run (default 1000).
+ *  -- "-c" checks that each line makes a single write() when line buffered,
+ *     if it has one newline and fits in the buffer.  Exits with 1 if not.
+ *  -- "-w" and "-i" limit the runs to one workload or implementation.
+ *
+ * ____________________________________________________________________________
+ *  Copyright © 2023, J. Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  Author:  Joe Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  SPDX-License-Identifier:  CC-BY-SA-4.0
+ ******************************************************************************/
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "sink.h"
+
+/*******************************************************************************
+ * Stdio wrappers, linked in with -Wl,--wrap=<name>.
+ ******************************************************************************/
+
+static uint64_t stdio_calls;
+
+size_t __real_fwrite(const void *ptr, size_t size, size_t n, FILE *f);
+int    __real_fputc(int c, FILE *f);
+int    __real_putc(int c, FILE *f);
+int    __real_fputs(const char *s, FILE *f);
+int    __real_putchar(int c);
+int    __real_puts(const char *s);
+
+size_t __wrap_fwrite(const void *ptr, size_t size, size_t n, FILE *f) {
+  stdio_calls++;
+  return __real_fwrite(ptr, size, n, f);
+}
+
+int __wrap_fputc(int c, FILE *f) {
+  stdio_calls++;
+  return __real_fputc(c, f);
+}
+
+int __wrap_putc(int c, FILE *f) {
+  stdio_calls++;
+  return __real_putc(c, f);
+}
+
+int __wrap_fputs(const char *s, FILE *f) {
+  stdio_calls++;
+  return __real_fputs(s, f);
+}
+
+int __wrap_putchar(int c) {
+  stdio_calls++;
+  return __real_putchar(c);
+}
+
+int __wrap_puts(const char *s) {
+  stdio_calls++;
+  return __real_puts(s);
+}
+
+int __wrap_printf(const char *fmt, ...) {
+  stdio_calls++;
+  va_list args;
+  va_start(args, fmt);
+  const int ret = vprintf(fmt, args);
+  va_end(args);
+  return ret;
+}
+
+
+/*******************************************************************************
+ * Counting
+ ******************************************************************************/
+
+/* Kinds of stdio buffering to try. */
+static const struct { int mode; const char *name; } bufferings[] = {
+  { _IOFBF, "full" }, { _IOLBF, "line" }, { _IONBF, "none" },
+};
+
+#define NUM_BUFFERINGS (sizeof(bufferings) / sizeof(bufferings[0]))
+
+/* Per-line results of one run. */
+struct calls {
+  double stdio;
+  double writes;
+  double bytes;
+  double newlines;
+};
+
+/* Runs n lines of a workload through stdout, with the given buffering. */
+static bool count_calls(bench_stream_runner *runner, int buffering, unsigned n,
+                        struct calls *calls) {
+  FILE *const sink = sink_open();
+  if (!sink) { return false; }
+  setvbuf(sink, NULL, buffering, BUFSIZ);
+
+  FILE *const out = stdout;
+  stdout = sink;
+
+  stdio_calls = sink_writes = sink_bytes = sink_newlines = 0;
+  runner(0, n);
+  const uint64_t stdio = stdio_calls;  /* Not counting our own fflush(). */
+  fflush(sink);
+
+  stdout = out;
+  fclose(sink);
+
+  calls->stdio = (double)stdio / n;
+  calls->writes = (double)sink_writes / n;
+  calls->bytes = (double)sink_bytes / n;
+  calls->newlines = (double)sink_newlines / n;
+  return true;
+}
+
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "Usage: %s [-n lines] [-c] [-w workload] [-i impl]\n",
+          argv0);
+  exit(2);
+}
+
+int main(int argc, char *argv[]) {
+  unsigned lines = 1000;
+  bool check = false;
+  const char *only_workload = NULL, *only_impl = NULL;
+
+  for (int opt; (opt = getopt(argc, argv, "n:cw:i:")) != -1;) {
+    switch (opt) {
+      case 'n': { lines = strtoul(optarg, NULL, 0); break; }
+      case 'c': { check = true;                      break; }
+      case 'w': { only_workload = optarg;            break; }
+      case 'i': { only_impl = optarg;                break; }
+      default:  { usage(argv[0]); }
+    }
+  }
+
+  if (lines < 1) { usage(argv[0]); }
+
+  sink_count_lines = true;
+  int failures = 0;
+
+  fprintf(stdout, "%-12s %-5s %-6s %12s %12s %12s\n",
+          "workload", "impl", "buffer", "stdio/line", "writes/line",
+          "bytes/line");
+
+  for (size_t w = 0; w < BENCH_NUM_WORKLOADS; w++) {
+    const struct bench_workload *const wl = &bench_workloads[w];
+    if (only_workload && strcmp(only_workload, wl->name)) { continue; }
+
+    for (size_t i = 0; i < BENCH_NUM_IMPLS; i++) {
+      const struct bench_impl *impl = bench_impls[i];
+      if (only_impl && strcmp(only_impl, impl->name)) { continue; }
+      if (!bench_supports(impl, wl) || !impl->stream_runners) { continue; }
+
+      for (size_t b = 0; b < NUM_BUFFERINGS; b++) {
+        struct calls calls;
+        if (!count_calls(impl->stream_runners[w], bufferings[b].mode, lines,
+                         &calls)) {
+          perror("fopencookie");
+          return 1;
+        }
+
+        fprintf(stdout, "%-12s %-5s %-6s %12.2f %12.2f %12.1f",
+                wl->name, impl->name, bufferings[b].name,
+                calls.stdio, calls.writes, calls.bytes);
+
+        /* A line buffered line that fits should take exactly one write(). */
+        const bool checked = check && bufferings[b].mode == _IOLBF &&
+                             calls.newlines == 1 && calls.bytes < BUFSIZ;
+        if (checked && calls.writes != 1) {
+          fprintf(stdout, "  FAIL: expected 1 write/line");
+          failures++;
+        }
+        fprintf(stdout, "\n");
+      }
+    }
+  }
+
+  if (check) {
+    fprintf(stdout, "%d check%s failed.\n",
+            failures, failures == 1 ? "" : "s");
+  }
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * Hardware performance counters, via perf_event_open().  See counters.h.
+ *
+ * SPDX-License-Identifier:  CC-BY-SA-4.0
+ */
+
+#define _GNU_SOURCE  /* For syscall(). */
+
+#include "counters.h"
+
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+const char *const counter_names[kNumCounters] = {
+  [kCounterCycles]       = "cycles",
+  [kCounterInsns]        = "instructions",
+  [kCounterBranchMisses] = "branch_misses",
+  [kCounterL1dMisses]    = "l1d_misses",
+  [kCounterDivActive]    = "div_active",
+};
+
+/* Event types and configs, except the divider's, which is model specific. */
+static const struct { uint32_t type; uint64_t config; } events[] = {
+  [kCounterCycles]       = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+  [kCounterInsns]        = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+  [kCounterBranchMisses] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+  [kCounterL1dMisses]    = {
+    PERF_TYPE_HW_CACHE,
+    PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+    PERF_COUNT_HW_CACHE_RESULT_MISS << 16
+  },
+};
+
+/* ARITH.DIVIDER_ACTIVE on Intel since Skylake:  event 0x14, umask 1, cmask 1 */
+#define INTEL_DIVIDER_ACTIVE 0x01000114
+
+/* Returns the raw event for divider activity on this CPU, or 0 if unknown. */
+static uint64_t divider_event(void) {
+  const char *env = getenv("BENCH_DIV_EVENT");
+  if (env) { return strtoull(env, NULL, 0); }
+
+#if defined(__x86_64__) || defined(__i386__)
+  FILE *f = fopen("/proc/cpuinfo", "r");
+  if (!f) { return 0; }
+
+  char line[256];
+  uint64_t event = 0;
+  while (fgets(line, sizeof(line), f)) {
+    if (!strncmp(line, "vendor_id", 9)) {
+      event = strstr(line, "GenuineIntel") ? INTEL_DIVIDER_ACTIVE : 0;
+      break;
+    }
+  }
+
+  fclose(f);
+  return event;
+#else
+  return 0;
+#endif
+}
+
+/* Opens one counter for the calling thread, on any CPU.  Returns the fd. */
+static int open_counter(uint32_t type, uint64_t config) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;  /* Allowed at perf_event_paranoid 2. */
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+int counters_open(struct counters *c) {
+  int opened = 0;
+
+  for (int i = 0; i < kNumCounters; i++) {
+    if (i == kCounterDivActive) {
+      const uint64_t event = divider_event();
+      c->fd[i] = event ? open_counter(PERF_TYPE_RAW, event) : -1;
+    } else {
+      c->fd[i] = open_counter(events[i].type, events[i].config);
+    }
+    opened += c->fd[i] >= 0;
+  }
+
+  return opened;
+}
+
+void counters_start(struct counters *c) {
+  for (int i = 0; i < kNumCounters; i++) {
+    if (c->fd[i] < 0) { continue; }
+    ioctl(c->fd[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(c->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+void counters_stop(struct counters *c, uint64_t values[kNumCounters],
+                   bool valid[kNumCounters]) {
+  for (int i = 0; i < kNumCounters; i++) {
+    if (c->fd[i] >= 0) { ioctl(c->fd[i], PERF_EVENT_IOC_DISABLE, 0); }
+  }
+
+  for (int i = 0; i < kNumCounters; i++) {
+    uint64_t data[3];  /* Value, time enabled, time running. */
+    valid[i] = c->fd[i] >= 0 &&
+               read(c->fd[i], data, sizeof(data)) == sizeof(data) &&
+               data[2] > 0;
+    values[i] = !valid[i]            ? 0
+              : data[2] == data[1]   ? data[0]
+              : (uint64_t)((double)data[0] * data[1] / data[2]);
+  }
+}
+
+void counters_close(struct counters *c) {
+  for (int i = 0; i < kNumCounters; i++) {
+    if (c->fd[i] >= 0) { close(c->fd[i]); }
+    c->fd[i] = -1;
+  }
+}
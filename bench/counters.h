@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * Hardware performance counters around benchmark runs, via perf_event_open().
+ *
+ * Counters are optional, each on its own.  Any that the CPU, kernel or its
+ * perf_event_paranoid setting won't allow just read as unavailable.
+ *
+ * ____________________________________________________________________________
+ *  Copyright © 2023, J. Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  Author:  Joe Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  SPDX-License-Identifier:  CC-BY-SA-4.0
+ ******************************************************************************/
+
+#ifndef COUNTERS_H_
+#define COUNTERS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum {
+  kCounterCycles,        /* CPU cycles.                                    */
+  kCounterInsns,         /* Instructions retired.                          */
+  kCounterBranchMisses,  /* Mispredicted branches.                         */
+  kCounterL1dMisses,     /* L1 data cache read misses.                     */
+  kCounterDivActive,     /* Cycles the divider is busy.  Model specific:   */
+                         /* on Intel, ARITH.DIVIDER_ACTIVE, or set the raw */
+                         /* event in BENCH_DIV_EVENT.                      */
+  kNumCounters
+};
+
+/* Short names for each counter, such as "cycles". */
+extern const char *const counter_names[kNumCounters];
+
+struct counters {
+  int fd[kNumCounters];  /* -1 for counters that are unavailable. */
+};
+
+/* Opens the counters for the calling thread.  Returns how many opened. */
+int counters_open(struct counters *c);
+
+/* Zeroes and starts the counters. */
+void counters_start(struct counters *c);
+
+/*
+ * Stops the counters, and reads them into values[].  Sets valid[] to say
+ * which have values.  If the kernel had to time-share a counter with others,
+ * its value is scaled up to the whole run.
+ */
+void counters_stop(struct counters *c, uint64_t values[kNumCounters],
+                   bool valid[kNumCounters]);
+
+/* Closes the counters. */
+void counters_close(struct counters *c);
+
+#endif /* COUNTERS_H_ */
@@ -0,0 +1,113 @@
+/*
+ * Timing, statistics and CPU placement.  See harness.h.
+ *
+ * SPDX-License-Identifier:  CC-BY-SA-4.0
+ */
+
+#define _GNU_SOURCE  /* For sched_getcpu() and CPU_SET(). */
+
+#include "harness.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+
+double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int pin_to_cpu(int cpu) {
+  if (cpu < 0) { cpu = sched_getcpu(); }
+  if (cpu < 0 || cpu >= CPU_SETSIZE) { return -1; }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) ? -1 : cpu;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  const double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/*
+ * Two-sided 95% critical values of Student's t distribution, by degrees of
+ * freedom.  Past the end of the table, the normal distribution's 1.96 is
+ * close enough.
+ */
+static const double t_95[] = {
+  0,     12.71, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+  2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+  2.042
+};
+
+#define T_95_SIZE (int)(sizeof(t_95) / sizeof(t_95[0]))
+
+void summarize(double *samples, int n, struct sample_stats *stats) {
+  qsort(samples, n, sizeof(*samples), compare_doubles);
+  stats->median = n % 2 ? samples[n / 2]
+                        : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+
+  double sum = 0;
+  for (int i = 0; i < n; i++) { sum += samples[i]; }
+  stats->mean = sum / n;
+
+  if (n < 2) { stats->ci95 = 0; return; }
+
+  double sq = 0;
+  for (int i = 0; i < n; i++) {
+    sq += (samples[i] - stats->mean) * (samples[i] - stats->mean);
+  }
+  const double t = n - 1 < T_95_SIZE ? t_95[n - 1] : 1.96;
+  stats->ci95 = t * sqrt(sq / (n - 1)) / sqrt(n);
+}
+
+/* Returns the bucket for a value. */
+static int hist_index(uint64_t value) {
+  if (value < (1u << HIST_SUB_BITS)) { return value; }
+  const int shift = 63 - __builtin_clzll(value) - HIST_SUB_BITS;
+  return ((shift + 1) << HIST_SUB_BITS) +
+         (int)(value >> shift) - (1 << HIST_SUB_BITS);
+}
+
+/* Returns the largest value that lands in a bucket. */
+static uint64_t hist_value(int idx) {
+  if (idx < (1 << HIST_SUB_BITS)) { return idx; }
+  const int shift = (idx >> HIST_SUB_BITS) - 1;
+  const uint64_t sub = (idx & ((1 << HIST_SUB_BITS) - 1)) +
+                       (1u << HIST_SUB_BITS);
+  return ((sub + 1) << shift) - 1;
+}
+
+void hist_record(struct histogram *h, uint64_t value) {
+  h->counts[hist_index(value)]++;
+  h->total++;
+  if (value > h->max) { h->max = value; }
+}
+
+void hist_merge(struct histogram *dst, const struct histogram *src) {
+  for (int i = 0; i < HIST_BUCKETS; i++) { dst->counts[i] += src->counts[i]; }
+  dst->total += src->total;
+  if (src->max > dst->max) { dst->max = src->max; }
+}
+
+uint64_t hist_percentile(const struct histogram *h, double percentile) {
+  const uint64_t rank = (uint64_t)ceil(h->total * percentile / 100);
+  uint64_t seen = 0;
+
+  for (int i = 0; i < HIST_BUCKETS; i++) {
+    seen += h->counts[i];
+    if (seen >= rank && seen) {
+      const uint64_t value = hist_value(i);
+      return value < h->max ? value : h->max;
+    }
+  }
+
+  return h->max;
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+ * Timing, statistics and CPU placement shared by the benchmark programs.
+ *
+ * ____________________________________________________________________________
+ *  Copyright © 2023, J. Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  Author:  Joe Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  SPDX-License-Identifier:  CC-BY-SA-4.0
+ ******************************************************************************/
+
+#ifndef HARNESS_H_
+#define HARNESS_H_
+
+#include <stdint.h>
+
+/* Returns a monotonic time in nanoseconds. */
+double now_ns(void);
+
+/*
+ * Pins the calling thread to a CPU:  the given one, or if cpu is negative,
+ * the one it's running on now.  Returns the CPU, or -1 on failure.
+ */
+int pin_to_cpu(int cpu);
+
+/* Summary of a set of samples. */
+struct sample_stats {
+  double median;
+  double mean;
+  double ci95;  /* Half-width of the 95% confidence interval of the mean. */
+};
+
+/* Summarizes n samples, sorting them in place. */
+void summarize(double *samples, int n, struct sample_stats *stats);
+
+/*
+ * A latency histogram in the style of HdrHistogram:  each power of 2 splits
+ * into 2^HIST_SUB_BITS linear buckets, so any value lands in a bucket within
+ * about 3% of it, from 1 ns to the largest uint64_t, in a fixed 15 KiB.
+ */
+#define HIST_SUB_BITS 5
+#define HIST_BUCKETS  ((65 - HIST_SUB_BITS) << HIST_SUB_BITS)
+
+struct histogram {
+  uint64_t counts[HIST_BUCKETS];
+  uint64_t total;
+  uint64_t max;
+};
+
+/* Records a value. */
+void hist_record(struct histogram *h, uint64_t value);
+
+/* Adds the counts in src to dst. */
+void hist_merge(struct histogram *dst, const struct histogram *src);
+
+/* Returns the value at a percentile from 0 to 100, to the bucket's top. */
+uint64_t hist_percentile(const struct histogram *h, double percentile);
+
+#endif /* HARNESS_H_ */
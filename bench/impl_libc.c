@@ -0,0 +1,27 @@
+/*
+ * The C library's snprintf() and printf(), as the baseline.
+ *
+ * SPDX-License-Identifier:  CC-BY-SA-4.0
+ */
+
+#include <stdio.h>
+
+#include "bench.h"
+
+/*
+ * The corpus includes extension conversions the C library doesn't support.
+ * bench.c never runs those here, so don't warn about them.
+ */
+#pragma GCC diagnostic ignored "-Wformat"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#define BENCH_SNPRINTF snprintf
+#define BENCH_PRINTF   printf
+
+BENCH_DEFINE_BUF_RUNNERS
+BENCH_DEFINE_STREAM_RUNNERS
+
+const struct bench_impl bench_libc = {
+  .name = "libc", .version = 0,
+  .buf_runners = buf_runners, .stream_runners = stream_runners
+};
@@ -0,0 +1,21 @@
+/*
+ * Version 5, which only prints to stdout, and doesn't return a length.
+ *
+ * SPDX-License-Identifier:  CC-BY-SA-4.0
+ */
+
+#define main          v5_main
+#define simple_printf v5_printf
+
+#include "../simple_printf_v5.c"
+
+#include "bench.h"
+
+#define BENCH_PRINTF v5_printf
+
+BENCH_DEFINE_STREAM_RUNNERS
+
+const struct bench_impl bench_v5 = {
+  .name = "v5", .version = 5,
+  .buf_runners = NULL, .stream_runners = stream_runners
+};
@@ -0,0 +1,24 @@
+/*
+ * Version 6, which adds printing to a buffer.
+ *
+ * SPDX-License-Identifier:  CC-BY-SA-4.0
+ */
+
+#define main            v6_main
+#define simple_printf   v6_printf
+#define simple_snprintf v6_snprintf
+
+#include "../simple_printf_v6.c"
+
+#include "bench.h"
+
+#define BENCH_SNPRINTF v6_snprintf
+#define BENCH_PRINTF   v6_printf
+
+BENCH_DEFINE_BUF_RUNNERS
+BENCH_DEFINE_STREAM_RUNNERS
+
+const struct bench_impl bench_v6 = {
+  .name = "v6", .version = 6,
+  .buf_runners = buf_runners, .stream_runners = stream_runners
+};
@@ -0,0 +1,30 @@
+/*
+ * Version 7, which restructures the core around struct conv.
+ *
+ * SPDX-License-Identifier:  CC-BY-SA-4.0
+ */
+
+#define main             v7_main
+#define simple_printf    v7_printf
+#define simple_fprintf   v7_fprintf
+#define simple_snprintf  v7_snprintf
+#define simple_sprintf   v7_sprintf
+#define simple_vprintf   v7_vprintf
+#define simple_vfprintf  v7_vfprintf
+#define simple_vsnprintf v7_vsnprintf
+#define simple_vsprintf  v7_vsprintf
+
+#include "../simple_printf_v7.c"
+
+#include "bench.h"
+
+#define BENCH_SNPRINTF v7_snprintf
+#define BENCH_PRINTF   v7_printf
+
+BENCH_DEFINE_BUF_RUNNERS
+BENCH_DEFINE_STREAM_RUNNERS
+
+const struct bench_impl bench_v7 = {
+  .name = "v7", .version = 7,
+  .buf_runners = buf_runners, .stream_runners = stream_runners
+};
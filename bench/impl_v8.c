@@ -0,0 +1,34 @@
+/*
+ * Version 8, the current one, with the extension conversions.
+ *
+ * SPDX-License-Identifier:  CC-BY-SA-4.0
+ */
+
+#define main             v8_main
+#define simple_printf    v8_printf
+#define simple_fprintf   v8_fprintf
+#define simple_snprintf  v8_snprintf
+#define simple_sprintf   v8_sprintf
+#define simple_vprintf   v8_vprintf
+#define simple_vfprintf  v8_vfprintf
+#define simple_vsnprintf v8_vsnprintf
+#define simple_vsprintf  v8_vsprintf
+#define simple_printf_freeze_conversions  v8_freeze_conversions
+#define simple_printf_register_conversion v8_register_conversion
+#define simple_printf_register_named      v8_register_named
+#define simple_printf_set_thread_name     v8_set_thread_name
+
+#include "../simple_printf_v8.c"
+
+#include "bench.h"
+
+#define BENCH_SNPRINTF v8_snprintf
+#define BENCH_PRINTF   v8_printf
+
+BENCH_DEFINE_BUF_RUNNERS
+BENCH_DEFINE_STREAM_RUNNERS
+
+const struct bench_impl bench_v8 = {
+  .name = "v8", .version = 8,
+  .buf_runners = buf_runners, .stream_runners = stream_runners
+};
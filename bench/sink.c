@@ -0,0 +1,36 @@
+/*
+ * A FILE that counts bytes and discards them.  See sink.h.
+ *
+ * SPDX-License-Identifier:  CC-BY-SA-4.0
+ */
+
+#define _GNU_SOURCE  /* For fopencookie(). */
+
+#include "sink.h"
+
+#include <string.h>
+
+uint64_t sink_bytes;
+uint64_t sink_writes;
+uint64_t sink_newlines;
+bool     sink_count_lines;
+
+static ssize_t sink_write(void *cookie, const char *buf, size_t len) {
+  (void)cookie;
+  sink_bytes += len;
+  sink_writes++;
+
+  if (sink_count_lines) {
+    for (const char *p = buf, *e = buf + len;
+         (p = memchr(p, '\n', e - p)) != NULL; p++) {
+      sink_newlines++;
+    }
+  }
+
+  return len;
+}
+
+FILE *sink_open(void) {
+  const cookie_io_functions_t io = { .write = sink_write };
+  return fopencookie(NULL, "w", io);
+}
@@ -0,0 +1,32 @@
+/*******************************************************************************
+ * A FILE that counts the bytes written to it, and discards them.  Benchmarks
+ * print to it to measure formatting and stdio without the kernel.
+ *
+ * ____________________________________________________________________________
+ *  Copyright © 2023, J. Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  Author:  Joe Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  SPDX-License-Identifier:  CC-BY-SA-4.0
+ ******************************************************************************/
+
+#ifndef SINK_H_
+#define SINK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Totals across all sinks, as stdio flushes to them.  Each write is one call
+ * stdio makes to the sink, which is where a FILE on a file descriptor would
+ * make a write() system call.  Newlines are only counted if sink_count_lines
+ * is set.
+ */
+extern uint64_t sink_bytes;
+extern uint64_t sink_writes;
+extern uint64_t sink_newlines;
+extern bool     sink_count_lines;
+
+/* Opens a sink.  Returns NULL on failure. */
+FILE *sink_open(void);
+
+#endif /* SINK_H_ */
@@ -0,0 +1,377 @@
+/*******************************************************************************
+ * Microbenchmarks for each stage of printf_core in the current version:
+ *
+ *  -- parse:    parse_flags() through parse_length() on a corpus of specs.
+ *  -- fetch:    get_signed_integer() and get_unsigned_integer() for each
+ *               length modifier.
+ *  -- convert:  convert_integer_to_string() across magnitudes and bases.
+ *  -- emit:     each printer's copy(), fill() and putc().
+ *
+ * This includes the source file, so it can call its static functions.
+ *
+ * Usage:  stages [-t ms] [-r reps] [-c cpu] [-g group]
+ *
+ *  -- "-t" sets the target time of each timed run (default 10 ms).
+ *  -- "-r" sets how many timed runs to take (default 20).
+ *  -- "-c" pins the runs to a CPU (default: the one it starts on).
+ *  -- "-g" limits the runs to one stage group, such as "parse".
+ *
+ * Each line gives the mean nanoseconds per operation with its 95% confidence
+ * interval, and the median.
+ *
+ * ____________________________________________________________________________
+ *  Copyright © 2023, J. Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  Author:  Joe Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  SPDX-License-Identifier:  CC-BY-SA-4.0
+ ******************************************************************************/
+
+#define main v8_main
+
+#include "../simple_printf_v8.c"
+
+#undef main
+
+#include <stdlib.h>
+
+#include "harness.h"
+#include "sink.h"
+
+/*
+ * A stage to measure.  run() performs ops operations per iteration, n times,
+ * and returns something derived from the results so they aren't optimized
+ * away.  The other fields parameterize run().
+ */
+struct stage {
+  const char  *group;
+  char         label[32];
+  uintmax_t  (*run)(const struct stage *s, unsigned n);
+  int          ops;
+
+  const char  *spec;       /* parse:    The spec, after the '%'.          */
+  int          length;     /* fetch:    Length modifier.                  */
+  bool         is_signed;  /* fetch, convert:  Signed conversion.         */
+  uintmax_t    value;      /* convert:  Value to convert.                 */
+  int          base;       /* convert:  Radix.                            */
+  bool         to_file;    /* emit:     File printer, not buffer printer. */
+  char         fill_char;  /* emit:     Character for fill().             */
+  size_t       len;        /* emit:     Bytes per copy() or fill().       */
+  void       (*emit)(struct printer *p, const struct stage *s);
+};
+
+#define MAX_STAGES 64
+static struct stage stages[MAX_STAGES];
+static int num_stages;
+
+/* Adds a stage, labeled with a printf-style format.  Exits if the table is
+ * full, so a new stage can't silently overrun it. */
+static struct stage *add_stage(const char *group,
+                               uintmax_t (*run)(const struct stage *, unsigned),
+                               int ops, const char *label, ...) {
+  if (num_stages >= MAX_STAGES) {
+    fprintf(stderr, "More than %d stages; raise MAX_STAGES.\n", MAX_STAGES);
+    exit(1);
+  }
+  struct stage *s = &stages[num_stages++];
+  s->group = group;
+  s->run = run;
+  s->ops = ops;
+
+  va_list args;
+  va_start(args, label);
+  vsnprintf(s->label, sizeof(s->label), label, args);
+  va_end(args);
+  return s;
+}
+
+
+/*******************************************************************************
+ * Parsing
+ ******************************************************************************/
+
+/* Specs to parse.  Any "*" takes its value from the int arguments. */
+static const char *const parse_corpus[] = {
+  "d", "5d", "-08lld", "+.5hhx", "#*.*zx", "'-20s", "020.10jd", "lI"
+};
+
+/* Parses s->spec n times.  The variable arguments feed any "*". */
+static uintmax_t parse_spec(const struct stage *s, unsigned n, ...) {
+  va_list ap;
+  va_start(ap, n);
+  uintmax_t check = 0;
+
+  for (unsigned i = 0; i < n; i++) {
+    va_list args;
+    va_copy(args, ap);
+    struct conv conv = { .base = 10, .args = &args };
+
+    const char *fmt = s->spec;
+    fmt = parse_flags (fmt, &conv);
+    fmt = parse_width (fmt, &conv);
+    fmt = parse_prec  (fmt, &conv);
+    fmt = parse_length(fmt, &conv);
+    check += conv.width + conv.prec + conv.length + (fmt - s->spec);
+
+    va_end(args);
+  }
+
+  va_end(ap);
+  return check;
+}
+
+static uintmax_t run_parse(const struct stage *s, unsigned n) {
+  return parse_spec(s, n, 12, 5);
+}
+
+
+/*******************************************************************************
+ * Argument fetching:  each iteration fetches FETCH_ARGS arguments.
+ ******************************************************************************/
+
+#define FETCH_ARGS 8
+#define FETCH_ARGS_(type) \
+  (type)1, (type)-2, (type)3, (type)-4, (type)5, (type)-6, (type)7, (type)-8
+
+/* Fetches FETCH_ARGS arguments of s->length, n times. */
+static uintmax_t fetch_args(const struct stage *s, unsigned n, ...) {
+  va_list ap;
+  va_start(ap, n);
+  uintmax_t check = 0;
+
+  for (unsigned i = 0; i < n; i++) {
+    va_list args;
+    va_copy(args, ap);
+    struct conv conv = { .base = 10, .args = &args, .length = s->length };
+
+    for (int a = 0; a < FETCH_ARGS; a++) {
+      check += s->is_signed ? get_signed_integer(&conv)
+                            : get_unsigned_integer(&conv);
+    }
+
+    va_end(args);
+  }
+
+  va_end(ap);
+  return check;
+}
+
+static uintmax_t run_fetch(const struct stage *s, unsigned n) {
+  switch (s->length) {
+    case kLengthLong:     { return fetch_args(s, n, FETCH_ARGS_(long));      }
+    case kLengthLongLong: { return fetch_args(s, n, FETCH_ARGS_(long long)); }
+    case kLengthIntMaxT:  { return fetch_args(s, n, FETCH_ARGS_(intmax_t));  }
+    case kLengthSizeT:    { return fetch_args(s, n, FETCH_ARGS_(size_t));    }
+    case kLengthPtrDiffT: { return fetch_args(s, n, FETCH_ARGS_(ptrdiff_t)); }
+    default:              { return fetch_args(s, n, FETCH_ARGS_(int));       }
+  }
+}
+
+/* Length modifiers, and their names. */
+static const struct { int length; const char *name; } fetch_lengths[] = {
+  { kLengthChar,     "hh"   }, { kLengthShort,    "h"  },
+  { kLengthDefault,  "none" }, { kLengthLong,     "l"  },
+  { kLengthLongLong, "ll"   }, { kLengthIntMaxT,  "j"  },
+  { kLengthSizeT,    "z"    }, { kLengthPtrDiffT, "t"  },
+};
+
+
+/*******************************************************************************
+ * Integer conversion
+ ******************************************************************************/
+
+static uintmax_t run_convert(const struct stage *s, unsigned n) {
+  char buf[INT_BUF_SIZE];
+  uintmax_t check = 0;
+
+  for (unsigned i = 0; i < n; i++) {
+    struct conv conv = {
+      .base = s->base, .prec = 1, .is_signed = s->is_signed
+    };
+    check += convert_integer_to_string(s->value + (i & 1), &conv, buf);
+  }
+
+  return check;
+}
+
+/* Values to convert, from one digit to the most there can be. */
+static const struct { uintmax_t value; const char *name; } convert_values[] = {
+  { 7, "1 digit" }, { 12345, "5 digits" }, { 4000000000u, "10 digits" },
+  { UINTMAX_MAX - 1, "max" },
+};
+
+
+/*******************************************************************************
+ * Emission, through a buffer printer or a FILE printer on a sink.
+ ******************************************************************************/
+
+static FILE *emit_sink;
+
+static void emit_copy(struct printer *p, const struct stage *s) {
+  static const char text[256] =
+      "The quick brown fox jumps over the lazy dog.  Pack my box with five "
+      "dozen liquor jugs.  How vexingly quick daft zebras jump!";
+  p->copy(p, text, text + s->len);
+}
+
+static void emit_fill(struct printer *p, const struct stage *s) {
+  p->fill(p, s->fill_char, s->len);
+}
+
+static void emit_putc(struct printer *p, const struct stage *s) {
+  p->putc(p, s->fill_char);
+}
+
+static uintmax_t run_emit(const struct stage *s, unsigned n) {
+  static char buf[8192];
+  struct printer p = s->to_file ? (struct printer){
+    .file = emit_sink,
+    .copy = printer_file_copy, .copy_str = printer_file_copy_str,
+    .fill = printer_file_fill, .putc = printer_file_putc,
+    .done = printer_file_done
+  } : (struct printer){
+    .buf = buf, .max = sizeof(buf) - 1,
+    .copy = printer_buf_copy, .copy_str = printer_buf_copy_str,
+    .fill = printer_buf_fill, .putc = printer_buf_putc,
+    .done = printer_buf_done
+  };
+
+  uintmax_t check = 0;
+  for (unsigned i = 0; i < n; i++) {
+    p.total = 0;  /* So the buffer printer always has room. */
+    s->emit(&p, s);
+    check += p.total;
+  }
+
+  if (s->to_file) { fflush(emit_sink); }
+  return check;
+}
+
+static void add_emit_stages(bool to_file) {
+  const char *const name = to_file ? "file" : "buf";
+  static const size_t copy_lens[] = { 1, 16, 200 };
+  static const size_t fill_lens[] = { 16, 5000 };
+
+  for (size_t i = 0; i < sizeof(copy_lens) / sizeof(copy_lens[0]); i++) {
+    struct stage *s = add_stage("emit", run_emit, 1, "%s copy %zu",
+                                name, copy_lens[i]);
+    s->to_file = to_file; s->len = copy_lens[i]; s->emit = emit_copy;
+  }
+
+  for (size_t i = 0; i < sizeof(fill_lens) / sizeof(fill_lens[0]); i++) {
+    static const char fill_chars[] = { ' ', '0', '-' };
+    for (size_t c = 0; c < sizeof(fill_chars); c++) {
+      struct stage *s = add_stage("emit", run_emit, 1, "%s fill '%c' %zu",
+                                  name, fill_chars[c], fill_lens[i]);
+      s->to_file = to_file; s->len = fill_lens[i];
+      s->fill_char = fill_chars[c]; s->emit = emit_fill;
+    }
+  }
+
+  struct stage *s = add_stage("emit", run_emit, 1, "%s putc", name);
+  s->to_file = to_file; s->fill_char = 'x'; s->emit = emit_putc;
+}
+
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+
+static void add_stages(void) {
+  for (size_t i = 0; i < sizeof(parse_corpus) / sizeof(parse_corpus[0]); i++) {
+    add_stage("parse", run_parse, 1, "%%%s", parse_corpus[i])->spec =
+        parse_corpus[i];
+  }
+
+  for (int is_signed = 1; is_signed >= 0; is_signed--) {
+    for (size_t i = 0; i < sizeof(fetch_lengths) / sizeof(fetch_lengths[0]);
+         i++) {
+      struct stage *s = add_stage("fetch", run_fetch, FETCH_ARGS, "%s %s",
+                                  is_signed ? "signed" : "unsigned",
+                                  fetch_lengths[i].name);
+      s->length = fetch_lengths[i].length;
+      s->is_signed = is_signed;
+    }
+  }
+
+  static const int bases[] = { 10, 16, 8 };
+  for (size_t b = 0; b < sizeof(bases) / sizeof(bases[0]); b++) {
+    for (size_t i = 0; i < sizeof(convert_values) / sizeof(convert_values[0]);
+         i++) {
+      struct stage *s = add_stage("convert", run_convert, 1, "base %d, %s",
+                                  bases[b], convert_values[i].name);
+      s->base = bases[b];
+      s->value = convert_values[i].value;
+    }
+  }
+
+  add_emit_stages(false);
+  add_emit_stages(true);
+}
+
+#define MAX_REPS 1000
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "Usage: %s [-t ms] [-r reps] [-c cpu] [-g group]\n", argv0);
+  exit(2);
+}
+
+int main(int argc, char *argv[]) {
+  double target_ms = 10;
+  int reps = 20, cpu = -1;
+  const char *only_group = NULL;
+
+  for (int opt; (opt = getopt(argc, argv, "t:r:c:g:")) != -1;) {
+    switch (opt) {
+      case 't': { target_ms = atof(optarg);  break; }
+      case 'r': { reps = atoi(optarg);       break; }
+      case 'c': { cpu = atoi(optarg);        break; }
+      case 'g': { only_group = optarg;       break; }
+      default:  { usage(argv[0]); }
+    }
+  }
+
+  if (target_ms <= 0 || reps < 1 || reps > MAX_REPS) { usage(argv[0]); }
+
+  emit_sink = sink_open();
+  if (!emit_sink) { perror("fopencookie"); return 1; }
+
+  cpu = pin_to_cpu(cpu);
+  if (cpu < 0) { fprintf(stderr, "Couldn't pin to a CPU.\n"); }
+
+  add_stages();
+
+  printf("Pinned to CPU %d; %d runs of %g ms each.\n", cpu, reps, target_ms);
+  printf("%-8s %-22s %10s %9s %10s\n",
+         "stage", "case", "mean ns/op", "+/- 95%", "median");
+
+  static volatile uintmax_t check;  /* Keeps results from being unused. */
+  static double samples[MAX_REPS];
+
+  for (int i = 0; i < num_stages; i++) {
+    const struct stage *s = &stages[i];
+    if (only_group && strcmp(only_group, s->group)) { continue; }
+
+    /* Find an iteration count that takes about the target time. */
+    unsigned n = 1;
+    while (n < UINT32_MAX / 2) {
+      const double start = now_ns();
+      check += s->run(s, n);
+      if (now_ns() - start >= target_ms * 1e6) { break; }
+      n *= 2;
+    }
+
+    for (int r = 0; r < reps; r++) {
+      const double start = now_ns();
+      check += s->run(s, n);
+      samples[r] = (now_ns() - start) / ((double)n * s->ops);
+    }
+
+    struct sample_stats stats;
+    summarize(samples, reps, &stats);
+    printf("%-8s %-22s %10.2f %9.2f %10.2f\n",
+           s->group, s->label, stats.mean, stats.ci95, stats.median);
+    fflush(stdout);
+  }
+
+  fclose(emit_sink);
+  return 0;
+}
@@ -0,0 +1,267 @@
+/*******************************************************************************
+ * Measures how printing scales with threads:  aggregate throughput, plus the
+ * p50, p99 and p99.9 latency of each call, from 1 thread up to a maximum.
+ *
+ * Every thread runs the same workload on the same implementation, either into
+ * its own buffer ("buf"), or to stdout ("stream"), which all threads share,
+ * and which points at a counting sink.  The C library locks a FILE inside
+ * each stdio call.  The simple_printf versions make several stdio calls per
+ * line, so lines from different threads may interleave at the sink.
+ *
+ * By default, each thread calls as fast as it can, and latency is the time
+ * each call takes.  With "-R", each thread instead starts calls on a fixed
+ * schedule, and latency runs from each call's scheduled start.  A stall then
+ * counts against every call it delays, instead of hiding them, so the tail
+ * isn't understated by coordinated omission.
+ *
+ * Usage:  threads [-T max] [-d ms] [-R rate] [-p] [-w workload] [-i impl]
+ *                 [-m buf|stream]
+ *
+ *  -- "-T" sets the most threads (default: CPUs online).  Runs double the
+ *     thread count from 1 up to it.
+ *  -- "-d" sets how long each run lasts (default 500 ms).
+ *  -- "-R" sets the calls per second each thread starts (default: closed
+ *     loop, as fast as possible).
+ *  -- "-p" pins thread k to CPU k, wrapping around.
+ *  -- "-w", "-i" and "-m" pick the workload (default "integer"), the
+ *     implementation (default "v8") and the mode (default "stream").
+ *
+ * ____________________________________________________________________________
+ *  Copyright © 2023, J. Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  Author:  Joe Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  SPDX-License-Identifier:  CC-BY-SA-4.0
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "harness.h"
+#include "sink.h"
+
+/* What every thread runs, and how. */
+struct config {
+  bench_buf_runner    *buf_runner;     /* One of these is set. */
+  bench_stream_runner *stream_runner;
+  double               interval_ns;    /* Open loop:  time between calls. */
+  bool                 pin;
+};
+
+/*
+ * Each thread's state and results.  Threads update their calls and histogram
+ * on every call, so each worker gets its own cache lines, lest false sharing
+ * skew the scaling we're here to measure.
+ */
+#define CACHE_LINE_SIZE 64
+
+struct worker {
+  _Alignas(CACHE_LINE_SIZE)
+  pthread_t              thread;
+  int                    index;
+  const struct config   *config;
+  atomic_bool           *go;
+  atomic_bool           *stop;
+  uint64_t               calls;
+  struct histogram       hist;
+};
+
+/* Waits until a time from now_ns(), sleeping if it's far enough away. */
+static void wait_until(double when_ns) {
+  for (double now = now_ns(); now < when_ns; now = now_ns()) {
+    const double left = when_ns - now;
+    if (left > 50000) {  /* Sleep most of the way, then spin. */
+      const double sleep_ns = left - 20000;
+      const struct timespec ts = {
+        .tv_sec = sleep_ns / 1e9, .tv_nsec = (long)sleep_ns % 1000000000
+      };
+      nanosleep(&ts, NULL);
+    }
+  }
+}
+
+static void *run_worker(void *arg) {
+  struct worker *const w = arg;
+  const struct config *const c = w->config;
+  char buf[BENCH_BUF_SIZE];
+
+  if (c->pin) {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    pin_to_cpu(w->index % (cpus > 0 ? cpus : 1));
+  }
+
+  while (!atomic_load(w->go)) { sched_yield(); }
+
+  /* Spread iteration numbers across threads, so arguments vary. */
+  unsigned i = w->index * 1000003u;
+  const double first_ns = now_ns();
+
+  while (!atomic_load_explicit(w->stop, memory_order_relaxed)) {
+    double start = now_ns();
+    if (c->interval_ns > 0) {  /* Open loop:  start on schedule. */
+      const double scheduled = first_ns + w->calls * c->interval_ns;
+      wait_until(scheduled);
+      start = scheduled;
+    }
+
+    if (c->buf_runner) {
+      c->buf_runner(buf, sizeof(buf), i++, 1);
+    } else {
+      c->stream_runner(i++, 1);
+    }
+
+    const double end = now_ns();
+    hist_record(&w->hist, end > start ? (uint64_t)(end - start) : 0);
+    w->calls++;
+  }
+
+  return NULL;
+}
+
+/* Runs one thread count.  Fills in the merged histogram and total calls. */
+static bool run_threads(const struct config *config, int num_threads,
+                        double duration_ms, struct histogram *hist,
+                        double *calls_per_sec) {
+  struct worker *const workers =
+      aligned_alloc(CACHE_LINE_SIZE, num_threads * sizeof(*workers));
+  if (!workers) { return false; }
+
+  atomic_bool go = false, stop = false;
+
+  int started = 0;
+  for (; started < num_threads; started++) {
+    struct worker *const w = &workers[started];
+    *w = (struct worker){
+      .index = started, .config = config, .go = &go, .stop = &stop
+    };
+    if (pthread_create(&w->thread, NULL, run_worker, w)) { break; }
+  }
+
+  /* If they didn't all start, stop the ones that did right away. */
+  if (started < num_threads) { atomic_store(&stop, true); }
+
+  const double begin = now_ns();
+  atomic_store(&go, true);
+  if (started == num_threads) { wait_until(begin + duration_ms * 1e6); }
+  atomic_store(&stop, true);
+
+  uint64_t calls = 0;
+  memset(hist, 0, sizeof(*hist));
+  for (int t = 0; t < started; t++) {
+    pthread_join(workers[t].thread, NULL);
+    hist_merge(hist, &workers[t].hist);
+    calls += workers[t].calls;
+  }
+  const double elapsed = now_ns() - begin;
+
+  free(workers);
+
+  *calls_per_sec = calls * 1e9 / elapsed;
+  return started == num_threads;
+}
+
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "Usage: %s [-T max] [-d ms] [-R rate] [-p] [-w workload] "
+                  "[-i impl] [-m buf|stream]\n", argv0);
+  exit(2);
+}
+
+int main(int argc, char *argv[]) {
+  long max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  double duration_ms = 500, rate = 0;
+  bool pin = false;
+  const char *workload = "integer", *impl_name = "v8", *mode = "stream";
+
+  for (int opt; (opt = getopt(argc, argv, "T:d:R:pw:i:m:")) != -1;) {
+    switch (opt) {
+      case 'T': { max_threads = atol(optarg);  break; }
+      case 'd': { duration_ms = atof(optarg);  break; }
+      case 'R': { rate = atof(optarg);         break; }
+      case 'p': { pin = true;                  break; }
+      case 'w': { workload = optarg;           break; }
+      case 'i': { impl_name = optarg;          break; }
+      case 'm': { mode = optarg;               break; }
+      default:  { usage(argv[0]); }
+    }
+  }
+
+  if (max_threads < 1 || duration_ms <= 0 || rate < 0) { usage(argv[0]); }
+
+  /* Find the workload and implementation. */
+  size_t w = 0;
+  while (w < BENCH_NUM_WORKLOADS && strcmp(bench_workloads[w].name, workload)) {
+    w++;
+  }
+  const struct bench_impl *impl = NULL;
+  for (size_t i = 0; i < BENCH_NUM_IMPLS; i++) {
+    if (!strcmp(bench_impls[i]->name, impl_name)) { impl = bench_impls[i]; }
+  }
+  if (w == BENCH_NUM_WORKLOADS || !impl ||
+      !bench_supports(impl, &bench_workloads[w])) {
+    fprintf(stderr, "No workload \"%s\" for implementation \"%s\".\n",
+            workload, impl_name);
+    return 2;
+  }
+
+  struct config config = {
+    .interval_ns = rate > 0 ? 1e9 / rate : 0, .pin = pin
+  };
+  if (!strcmp(mode, "buf") && impl->buf_runners) {
+    config.buf_runner = impl->buf_runners[w];
+  } else if (!strcmp(mode, "stream") && impl->stream_runners) {
+    config.stream_runner = impl->stream_runners[w];
+  } else {
+    fprintf(stderr, "No mode \"%s\" for implementation \"%s\".\n",
+            mode, impl_name);
+    return 2;
+  }
+
+  /* Results go to the real stdout, and stream runs go to the shared sink. */
+  FILE *const out = stdout;
+  FILE *const sink = sink_open();
+  if (!sink) { perror("fopencookie"); return 1; }
+  stdout = sink;
+
+  fprintf(out, "%s, %s, %s; %s", workload, impl_name, mode,
+          rate > 0 ? "open loop" : "closed loop");
+  if (rate > 0) { fprintf(out, " at %g calls/s/thread", rate); }
+  fprintf(out, "%s.\n", pin ? ", pinned" : "");
+  fprintf(out, "%8s %14s %10s %10s %10s %10s\n",
+          "threads", "calls/s", "p50 ns", "p99 ns", "p99.9 ns", "max ns");
+
+  static struct histogram hist;
+  for (long threads = 1;; threads *= 2) {
+    if (threads > max_threads) { threads = max_threads; }
+
+    double calls_per_sec;
+    if (!run_threads(&config, threads, duration_ms, &hist, &calls_per_sec)) {
+      fprintf(stderr, "Couldn't start %ld threads.\n", threads);
+      break;
+    }
+
+    fprintf(out, "%8ld %14.0f %10llu %10llu %10llu %10llu\n",
+            threads, calls_per_sec,
+            (unsigned long long)hist_percentile(&hist, 50),
+            (unsigned long long)hist_percentile(&hist, 99),
+            (unsigned long long)hist_percentile(&hist, 99.9),
+            (unsigned long long)hist.max);
+    fflush(out);
+
+    if (threads == max_threads) { break; }
+  }
+
+  stdout = out;
+  fclose(sink);
+  return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Workload arguments and descriptions, and the list of implementations.  See
+ * bench.h.
+ *
+ * SPDX-License-Identifier:  CC-BY-SA-4.0
+ */
+
+#include <string.h>
+
+#include "bench.h"
+
+const char *const bench_words[8] = {
+  "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel"
+};
+
+/* CSV fields, from needing no quotes to needing quotes and doubled quotes. */
+const char *const bench_fields[4] = {
+  "plain", "with, comma", "say \"hi\"", "multi\nline"
+};
+
+/*
+ * Quotes a field per RFC 4180 only if it needs it, doubling any quotes, just
+ * as %Q does.  Fields too long for the buffer get cut short.
+ */
+const char *bench_csv_field(int slot, const char *field) {
+  static _Thread_local char bufs[3][64];
+  char *const buf = bufs[slot];
+
+  if (!strpbrk(field, "\",\n\r")) { return field; }
+
+  size_t len = 0;
+  buf[len++] = '"';
+  for (; *field && len < sizeof(bufs[0]) - 3; field++) {
+    if (*field == '"') { buf[len++] = '"'; }
+    buf[len++] = *field;
+  }
+  buf[len++] = '"';
+  buf[len]   = '\0';
+  return buf;
+}
+
+const unsigned char bench_ipv4[4] = { 192, 168, 1, 254 };
+const unsigned char bench_ipv6[16] = {
+  0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0x00, 0x01, 0x00, 0x42
+};
+const unsigned char bench_mac[6] = { 0x00, 0x1a, 0x2b, 0x3c, 0x4d, 0x5e };
+
+#define WORKLOAD_ENTRY_(name, since, libc, ...) { #name, since, libc },
+
+const struct bench_workload bench_workloads[BENCH_NUM_WORKLOADS] = {
+  BENCH_WORKLOADS(WORKLOAD_ENTRY_)
+};
+
+#undef WORKLOAD_ENTRY_
+
+const struct bench_impl *const bench_impls[BENCH_NUM_IMPLS] = {
+  &bench_libc, &bench_v5, &bench_v6, &bench_v7, &bench_v8
+};
+
+bool bench_supports(const struct bench_impl *impl,
+                    const struct bench_workload *w) {
+  return impl->version ? impl->version >= w->since : w->libc;
+}
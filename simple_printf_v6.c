@@ -278,10 +278,13 @@ static void store_character_count(va_list *args, int size, size_t total) {
  *
  * I guess it's no longer so simple...
  */
-static void printf_core(struct printer *p, const char *fmt, va_list args) {
+static void printf_core(struct printer *p, const char *fmt, va_list ap) {
   char buf[INT_BUF_SIZE];
   const char *pfmt = NULL;
 
+  va_list args;  /* &args isn't portable if va_list is an array type. */
+  va_copy(args, ap);
+
   for (int ch = *fmt++; ch; ch = *fmt++) {
     /*
      * If it's not %, just print the character. The span [pfmt, fmt) holds
@@ -524,6 +527,8 @@ static void printf_core(struct printer *p, const char *fmt, va_list args) {
     p->copy(p, pfmt, fmt - pfmt - 1);
     pfmt = NULL;
   }
+
+  va_end(args);
 }
 
 
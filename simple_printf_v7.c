@@ -175,6 +175,9 @@ static bool print_converted_string(struct conv *restrict conv,
  * This implements the outer loop that drives the conversion process.
  ******************************************************************************/
 static size_t printf_core(struct printer *p, const char *fmt, va_list args) {
+  va_list args_copy;  /* &args isn't portable if va_list is an array type. */
+  va_copy(args_copy, args);
+
   const char *curr_fmt = fmt;
   const char *prev_fmt = fmt;                 /* Previous format pointer. */
   const char *term_fmt = fmt + strlen(fmt);   /* Null terminator in format. */
@@ -188,7 +191,7 @@ static size_t printf_core(struct printer *p, const char *fmt, va_list args) {
 
     /* It's (potentially) a conversion. Let's take a look. */
     const char *conv_fmt = curr_fmt++;  /* Point to first char of conversion. */
-    struct conv conv = { .base = 10, .args = &args, .printer = p };
+    struct conv conv = { .base = 10, .args = &args_copy, .printer = p };
 
     /* Look for exactly "%%", so that errors like "%l%d" don't print as '%'. */
     if (*curr_fmt == '%') { p->putc(p, '%'); curr_fmt++; continue; }
@@ -210,6 +213,7 @@ static size_t printf_core(struct printer *p, const char *fmt, va_list args) {
   if (prev_fmt != term_fmt) { p->copy(p, prev_fmt, term_fmt); }
 
   p->done(p);
+  va_end(args_copy);
 
   return p->total;
 }
@@ -0,0 +1,3359 @@
+/*******************************************************************************
+ * This file implements a simplified printf that understands:
+ *
+ *  -- Strings: "s"
+ *  -- Characters: "c"
+ *  -- Repeated characters: "=", printing an int char width times, for rules
+ *     and table borders.  "l=" repeats a wint_t, encoded as UTF-8.
+ *  -- Wide strings and characters: "ls", "lc", encoded as UTF-8.
+ *  -- String slices: "zs", taking a size_t length followed by a pointer.
+ *  -- Scatter/gather strings: "V", taking a struct iovec * and an int count.
+ *  -- Streamed strings: "R", taking a struct simple_reader *.
+ *  -- Hex dumps: "r", taking a pointer and a size_t length.
+ *      -- " " to separate groups of bytes; precision sets the group size.
+ *      -- "#" for a multi-line dump with offsets and ASCII, like xxd.
+ *  -- Base64 and base32: "Y" and "y", taking a pointer and a size_t length.
+ *      -- "#" for URL-safe base64 ("Y"), or base32hex ("y").
+ *      -- "+" to omit the trailing "=" padding.
+ *  -- Timestamps: "T", in UTC as ISO 8601, taking a struct timespec *.
+ *      -- "jT" takes an intmax_t count of nanoseconds since the epoch instead.
+ *      -- "#" for RFC 3339's space between the date and time, instead of "T".
+ *      -- Precision gives the digits of fractional seconds, 0 to 9.
+ *  -- Network addresses and IDs, each taking a pointer to the binary value:
+ *      -- IPv4 addresses: "I", from 4 bytes in network order.
+ *      -- IPv6 addresses: "lI", from 16 bytes, compressed per RFC 5952.
+ *      -- MAC addresses: "M", from 6 bytes.
+ *      -- UUIDs: "W", from 16 bytes.
+ *  -- The message for errno's value on entry: "m", or "#m" for its name.
+ *  -- Process and thread identity, from per-thread caches:
+ *      -- "P" for the process ID, "lP" for the thread ID.  Without a
+ *         gettid system call, "lP" prints nothing.
+ *      -- "#P" for the thread's name.  Rename threads with
+ *         simple_printf_set_thread_name() to keep the cache up to date.
+ *  -- Custom conversions, registered at run time:
+ *      -- By letter, with simple_printf_register_conversion().
+ *      -- By name, as "{name}", with simple_printf_register_named().
+ *      -- simple_printf_freeze_conversions() ends registration.
+ *  -- Humanized quantities, taking a uint64_t, with precision giving the
+ *     significant digits:
+ *      -- Durations: "N", from nanoseconds to "ns", "us", "ms" or "s".
+ *      -- Byte sizes: "K", to "B", "KiB", "MiB", etc., or "#K" for "kB", "MB".
+ *  -- Escaped strings, which take a string just like "s" and "zs":
+ *      -- JSON: "J", or "#J" to add the surrounding quotes.
+ *      -- Quoted C literal: "q", escaping non-printables as "\n", "\ooo", etc.
+ *      -- Quoted for POSIX shells: "#q", as $'...' with C escapes.
+ *      -- CSV field: "Q", quoted per RFC 4180 only if needed.
+ *      -- TSV field: "#Q", escaping tabs, newlines and backslashes.
+ *      -- URL percent-encoding: "U", or "#U" to leave reserved chars alone.
+ *  -- Integers:
+ *      -- Lengths: "hh", "h", "l", "ll", "j", "z", "t" and default int.
+ *      -- Signed decimal: "d", "i"
+ *      -- Unsigned decimal: "u"
+ *      -- Octal: "o"
+ *      -- Hexadecimal: "x", "X"
+ *  -- Pointers: "p".
+ *  -- Flags:
+ *      -- "#" for alternate form on "o", "x", and "X" conversions.
+ *      -- " " and "+" for sign on "d", "i" conversions.
+ *      -- "0" for leading zeros on integer conversions.
+ *      -- "-" for left-justified fields.
+ *      -- "'" to count UTF-8 characters, not bytes, on "s" and "c" fields.
+ *  -- Width and precision specifiers:
+ *      -- Supports dynamic values via "*".
+ *      -- Max integer precision is limited by INT_BUF_MAX.
+ *  -- Printing "%" with "%%".
+ *  -- Reporting length of printed string with "n".
+ *  -- Returning length of printed string.
+ *  -- Printing to a stream other than stdout.
+ *  -- Printing to a buffer.
+ *
+ * Not supported:
+ *  -- Floating point.
+ *
+ * I guess it's no longer so simple...
+ *
+ * ____________________________________________________________________________
+ *  Copyright © 2023, J. Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  Author:  Joe Zbiciak <joe.zbiciak@leftturnonly.info>
+ *  SPDX-License-Identifier:  CC-BY-SA-4.0
+ ******************************************************************************/
+
+#define _GNU_SOURCE  /* For thread IDs and names. */
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include <wchar.h>
+
+/*
+ * Some conversions need the "signed integer type corresponding to size_t."
+ * The language spec doesn't name the type, so try to determine it.
+ */
+#if ULLONG_MAX == SIZE_MAX
+typedef long long ssize_type;
+#elif ULONG_MAX == SIZE_MAX
+typedef long ssize_type;
+#elif UINT_MAX == SIZE_MAX
+typedef int ssize_type;
+#else
+#error Could not determine signed type corresponding to size_t.
+#endif
+
+/*
+ * Some conversions need the "unsigned integer type corresponding to ptrdiff_t."
+ * The language spec doesn't name the type, so try to determine it.
+ */
+#if LLONG_MAX == PTRDIFF_MAX
+typedef unsigned long long uptrdiff_type;
+#elif LONG_MAX == PTRDIFF_MAX
+typedef unsigned long uptrdiff_type;
+#elif INT_MAX == PTRDIFF_MAX
+typedef unsigned uptrdiff_type;
+#else
+#error Could not determine unsigned type corresponding to ptrdiff_t.
+#endif
+
+
+/* Operand sizes: */    /* Mod   diouxX conversions                 cs convs */
+enum {                  /* ----  ---------------------------------  -------- */
+  kLengthChar     = -2, /* hh    signed char, unsigned char                  */
+  kLengthShort    = -1, /*  h    short, unsigned short                       */
+  kLengthDefault  =  0, /* none  int, unsigned int, double,         char     */
+  kLengthLong     =  1, /*  l    long, unsigned long,               wchar_t  */
+  kLengthLongLong =  2, /* ll    long long int, unsigned long long           */
+  kLengthIntMaxT  =  3, /*  j    intmax_t                                    */
+  kLengthSizeT    =  4, /*  z    size_t                                      */
+  kLengthPtrDiffT =  5, /*  t    ptrdiff_t                                   */
+
+  kLengthVoidP    =  6  /* For %p, ignoring modifiers. */
+};
+
+/* Sign display: */     /* Flag   Non-negative values   Negative values      */
+enum {                  /* -----  --------------------  -------------------- */
+  kSignDefault = 0,     /* none   Nothing               '-'                  */
+  kSignAlways,          /*  +     '+'                   '-'                  */
+  kSignSpace            /* space  ' '                   '-'                  */
+};
+
+/* Abstracts text output and accounting for how much text we output. */
+struct printer {
+  union {
+    FILE *file;
+    char *buf;
+  };
+  size_t max;
+  size_t total;
+
+  /* Copies a block of text to the output. */
+  void (*copy)(struct printer *p, const char *first, const char *last);
+
+  /* Copies a string up to its null or max bytes.  Returns bytes copied. */
+  size_t (*copy_str)(struct printer *p, const char *s, size_t max);
+
+  /* Outputs a run of fill characters. */
+  void (*fill)(struct printer *p, char c, size_t length);
+
+  /* Outputs a single character. */
+  void (*putc)(struct printer *p, char c);
+
+  /* Ends text output for this printf call. */
+  void (*done)(struct printer *p);
+};
+
+/*
+ * Source of text for "R" conversions, pulled a chunk at a time so the text
+ * never needs to exist in one piece.  read() fills up to len bytes of buf and
+ * returns how many it filled, with 0 meaning there's no more.  size() returns
+ * the total length.  Only right-justified fields need it, and it may be NULL,
+ * in which case the field prints left-justified.
+ */
+struct simple_reader {
+  size_t (*read)(void *ctx, char *buf, size_t len);
+  size_t (*size)(void *ctx);
+  void   *ctx;
+};
+
+/*
+ * Describes how an escaping conversion escapes its string.  A byte needs an
+ * escape if it's below the "below" threshold, or 0x7F and up if "high" is
+ * set, or one of the special characters.  The escape() function writes the
+ * escape sequence for such a byte to buf[], returning its length.
+ */
+struct escape_style {
+  unsigned char below;          /* Escape bytes below this (0x80 at most). */
+  bool          high;           /* Escape 0x7F and above.                  */
+  char          special[4];     /* Escape these.  Repeat one to fill.      */
+  char          prefix;         /* Goes before the opening quote, if any.  */
+  int         (*escape)(unsigned char c, char *buf);
+};
+
+/*
+ * Conversion spec.  This is designed so that a default of all-zeros / false
+ * gives the desired result, for the most part.  The printf_core must init
+ * base to 10, as well as args and printer.
+ */
+struct conv {
+  bool          leading_zero;        /* Leading-zero flag.                   */
+  bool          left_justify;        /* Left justification flag.             */
+  bool          is_alt;              /* Alternate form flag.                 */
+  bool          count_chars;         /* Count UTF-8 chars, rather than bytes.*/
+  char          sign;                /* Sign display flag.                   */
+  char          length;              /* Length modifier (operand size).      */
+  bool          explicit_width;      /* True if user-provided width.         */
+  bool          explicit_prec;       /* True if user-provided precision.     */
+  int           width;               /* Width of the field.  Never negative. */
+  int           prec;                /* Precision.  Never negative.          */
+  bool          soft_prec;           /* Width converted to "precision."      */
+  bool          is_caps;             /* Print hex values in capital letters. */
+  bool          is_signed;           /* Perform a signed integer conversion. */
+  unsigned char base;                /* Default radix is decimal.            */
+  char          type;                /* Actual conversion to perform.        */
+
+  /* Additional details for handling the conversion. */
+  va_list        *restrict args;     /* Argument list.                       */
+  int             errnum;            /* Value of errno on entry, for "m".    */
+  struct printer *restrict printer;  /* Where to send output.                */
+  struct named_conversion *named;    /* The "{name}" conversion, if any.     */
+};
+
+/*
+ * A custom conversion.  It receives the parsed conversion spec, including its
+ * argument list, and the printer to send output to.  Most will fetch their
+ * argument with va_arg(*conv->args, ...), render it into a local buffer, and
+ * finish with print_converted_string() to honor the width and flags.  Returns
+ * true on success, or false to print the conversion spec as-is instead.
+ */
+typedef bool simple_conversion_fn(struct conv *restrict conv,
+                                  struct printer *restrict p);
+
+/*
+ * Custom conversions, both by letter and by name.  Registration takes a lock,
+ * and publishes each entry with a release store.  Lookups never lock: they're
+ * a single acquire load, which is a plain load on most CPUs.  Once frozen, the
+ * tables never change again.
+ */
+#define NAMED_CONVERSION_MAX 64  /* Power of 2.  At most 3/4 get used. */
+#define NAMED_CONVERSION_LEN 24  /* Longest name, including the null.    */
+
+struct named_conversion {
+  char                           name[NAMED_CONVERSION_LEN];
+  _Atomic(simple_conversion_fn *) fn;
+};
+
+static _Atomic(simple_conversion_fn *) custom_conversions[UCHAR_MAX + 1];
+static struct named_conversion named_conversions[NAMED_CONVERSION_MAX];
+static size_t named_conversion_count;
+static atomic_bool conversions_frozen;
+static pthread_mutex_t conversions_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* Forward declarations for conversion spec parsing functions. */
+static const char *parse_flags (const char *fmt, struct conv *restrict conv);
+static const char *parse_width (const char *fmt, struct conv *restrict conv);
+static const char *parse_prec  (const char *fmt, struct conv *restrict conv);
+static const char *parse_length(const char *fmt, struct conv *restrict conv);
+static const char *parse_name  (const char *fmt, struct conv *restrict conv);
+
+/* Forward declarations for format conversions. */
+static bool print_conversion         (struct conv *restrict conv);
+static bool print_char_conversion    (struct conv *restrict conv);
+static bool print_fill_conversion    (struct conv *restrict conv);
+static bool print_string_conversion  (struct conv *restrict conv);
+static bool print_wide_string        (struct conv *restrict conv);
+static bool print_string_slice       (struct conv *restrict conv);
+static bool print_iovec_conversion   (struct conv *restrict conv);
+static bool print_reader_conversion  (struct conv *restrict conv);
+static bool print_json_conversion    (struct conv *restrict conv);
+static bool print_quoted_conversion  (struct conv *restrict conv);
+static bool print_csv_conversion     (struct conv *restrict conv);
+static bool print_url_conversion     (struct conv *restrict conv);
+static bool print_hex_conversion     (struct conv *restrict conv);
+static bool print_base64_conversion  (struct conv *restrict conv);
+static bool print_base32_conversion  (struct conv *restrict conv);
+static bool print_time_conversion    (struct conv *restrict conv);
+static bool print_duration_conversion(struct conv *restrict conv);
+static bool print_size_conversion    (struct conv *restrict conv);
+static bool print_ip_conversion      (struct conv *restrict conv);
+static bool print_mac_conversion     (struct conv *restrict conv);
+static bool print_uuid_conversion    (struct conv *restrict conv);
+static bool print_errno_conversion   (struct conv *restrict conv);
+static bool print_identity_conversion(struct conv *restrict conv);
+static bool print_named_conversion   (struct conv *restrict conv);
+static bool print_diouxXp_conversions(struct conv *restrict conv);
+static bool store_character_count    (struct conv *restrict conv);
+
+/* Forward declarations for argument fetches. */
+static uintmax_t get_signed_integer  (struct conv *restrict conv);
+static uintmax_t get_unsigned_integer(struct conv *restrict conv);
+static bool get_string_argument(struct conv *restrict conv,
+                                const char **str, size_t *str_len);
+
+/* Utility functions used by the various conversions. */
+static int convert_integer_to_string(
+    uintmax_t value, struct conv *restrict conv, char *restrict buf);
+static bool print_converted_string(struct conv *restrict conv,
+                                   const char *restrict str, size_t str_len);
+static size_t pad_width(const struct conv *restrict conv, size_t len);
+static int encode_utf8(uint_least32_t cp, char *restrict buf);
+static size_t count_utf8_chars(const char *str, size_t len);
+static size_t skip_utf8_chars(const char *str, size_t len, size_t count);
+static size_t utf8_prefix_length(const char *str, size_t count);
+static size_t encode_wide_string(const wchar_t *ws, size_t ws_len,
+                                 size_t max_len, struct printer *p);
+static size_t encode_url(const char *s, const char *e, unsigned char keep,
+                         struct printer *p);
+static void print_hex_bytes(struct printer *p, const unsigned char *data,
+                            size_t len, size_t group);
+static void print_hex_dump(struct printer *p, const unsigned char *data,
+                           size_t len, size_t group);
+static bool print_base_n(struct conv *restrict conv, const char *digits,
+                         int bits);
+static const char *format_date_time(intmax_t sec);
+static int format_ipv4(const unsigned char *addr, char *restrict buf);
+static int format_ipv6(const unsigned char *addr, char *restrict buf);
+static int format_hex_fields(const unsigned char *bytes, const int *lengths,
+                             int num_fields, char sep, char *restrict buf);
+static const char *find_escape(const struct escape_style *style,
+                               const char *s, const char *e);
+static bool print_escaped_string(struct conv *restrict conv,
+                                 const struct escape_style *style, char quote,
+                                 const char *str, size_t str_len);
+
+/* Escaping styles, for the escaping conversions. */
+static const struct escape_style json_style;
+static const struct escape_style c_style;
+static const struct escape_style shell_style;
+static const struct escape_style csv_style;
+static const struct escape_style csv_quoted_style;
+static const struct escape_style tsv_style;
+
+
+/*******************************************************************************
+ * Core printf routine.
+ * 
+ * This implements the outer loop that drives the conversion process.
+ ******************************************************************************/
+static size_t printf_core(struct printer *p, const char *fmt, va_list args) {
+  const int errnum = errno;  /* Before we do anything that might change it. */
+
+  va_list args_copy;  /* &args isn't portable if va_list is an array type. */
+  va_copy(args_copy, args);
+
+  const char *curr_fmt = fmt;
+  const char *prev_fmt = fmt;                 /* Previous format pointer. */
+  const char *term_fmt = fmt + strlen(fmt);   /* Null terminator in format. */
+
+  /* Output spans of non-conversion chars, interspersed with conversions. */
+  for (curr_fmt = memchr(curr_fmt, '%', term_fmt - curr_fmt); curr_fmt;
+       prev_fmt = curr_fmt,
+       curr_fmt = memchr(curr_fmt, '%', term_fmt - curr_fmt)) {
+    /* Output spans of non-conversion characters in format. */
+    if (prev_fmt != curr_fmt) { p->copy(p, prev_fmt, curr_fmt); }
+
+    /* It's (potentially) a conversion. Let's take a look. */
+    const char *conv_fmt = curr_fmt++;  /* Point to first char of conversion. */
+    struct conv conv = {
+      .base = 10, .args = &args_copy, .errnum = errnum, .printer = p
+    };
+
+    /* Look for exactly "%%", so that errors like "%l%d" don't print as '%'. */
+    if (*curr_fmt == '%') { p->putc(p, '%'); curr_fmt++; continue; }
+
+    curr_fmt = parse_flags (curr_fmt, &conv);
+    curr_fmt = parse_width (curr_fmt, &conv);
+    curr_fmt = parse_prec  (curr_fmt, &conv);
+    curr_fmt = parse_length(curr_fmt, &conv);
+    curr_fmt = parse_name  (curr_fmt, &conv);
+
+    conv.type = *curr_fmt++;  /* Get the actual conversion character. */
+
+    if (!print_conversion(&conv)) {
+      /* Failed conversion. Print failed conversion specifier. */
+      p->copy(p, conv_fmt, curr_fmt);
+    }
+  }
+
+  /* Print the tail. */
+  if (prev_fmt != term_fmt) { p->copy(p, prev_fmt, term_fmt); }
+
+  p->done(p);
+  va_end(args_copy);
+
+  return p->total;
+}
+
+/*******************************************************************************
+ * Conversion specification parsing
+ ******************************************************************************/
+
+/* Parses any flags that are present.  They can appear in any order. */
+static const char *parse_flags(const char *fmt, struct conv *restrict conv) {
+  bool sign_space = false;
+
+  for (bool done_flags = false; !done_flags;) {
+    char ch = *fmt++;
+    switch (ch) {
+      case '0': { conv->leading_zero = true; break; }
+      case '-': { conv->left_justify = true; break; }
+      case '+': { conv->sign = kSignAlways;  break; }
+      case '#': { conv->is_alt = true;       break; }
+      case '\'':{ conv->count_chars = true;  break; }
+      case ' ': { sign_space = true;         break; }
+      default:  { done_flags = true; --fmt;  break; }
+    }
+  }
+
+  /* ' ' takes effect only if '+' isn't also provided. */
+  if (sign_space && conv->sign == kSignDefault) { conv->sign = kSignSpace; }
+
+  return fmt;
+}
+
+/* Parses the width specifier, if present. */
+static const char *parse_width(const char *fmt, struct conv *restrict conv) {
+  char ch = *fmt;
+  int width = 0;
+
+  /* Check for width. */
+  if (ch == '*') {  /* Width provided as an int argument. */
+    fmt++;
+    conv->explicit_width = true;
+    width = va_arg(*conv->args, int);
+
+    if (width < 0) {  /* Negative width specifies left justification. */
+      conv->left_justify = true;
+      width = width == INT_MIN ? INT_MAX : -width;
+    }
+  } else {  /* Width is a decimal number in the format string. */
+    conv->explicit_width = isdigit(ch);  /* Only true if there's a digit. */
+
+    while (isdigit(ch)) {  /* Saturate at INT_MAX, rather than overflow. */
+      width = width > (INT_MAX - 9) / 10 ? INT_MAX : width * 10 + (ch - '0');
+      ch = *++fmt;
+    }
+  }
+
+  conv->width = width;
+  return fmt;
+}
+
+/* Parses the precision specifier, if present. */
+static const char *parse_prec(const char *fmt, struct conv *restrict conv) {
+  if (*fmt != '.') { return fmt; }  /* Precision is always preceded by '.'. */
+
+  char ch = *++fmt;
+  int prec = 0;
+
+  conv->explicit_prec = true;
+
+  if (ch == '*') {  /* Precision provided as an int argument. */
+    ++fmt;
+    prec = va_arg(*conv->args, int);
+  } else {  /* Precision is a decimal number in the format string. */
+    while (isdigit(ch)) {  /* Saturate at INT_MAX, rather than overflow. */
+      prec = prec > (INT_MAX - 9) / 10 ? INT_MAX : prec * 10 + (ch - '0');
+      ch = *++fmt;
+    }
+  }
+
+  conv->prec = prec < 0 ? 0 : prec; /* Negative precision acts like 0. */
+  return fmt;
+}
+
+/*
+ * Parses length modifiers "hh", "h", "l", "ll", "j", "z", "t", and peeks
+ * ahead for "p" as it has an implicit, fixed size.
+ *
+ * An invalid conversion such as "%hhp" will behave like "%#hhx".  That's OK,
+ * as we're in "undefined behavior" territory.
+ */
+static const char *parse_length(const char *fmt, struct conv *restrict conv) {
+  int length = kLengthDefault;
+  int ch1 = fmt[0], ch2 = ch1 ? fmt[1] : 0;
+
+# define PACK_CHAR_(a, b) (((a) & UCHAR_MAX) | (((a) == (b)) << CHAR_BIT))
+
+  switch (PACK_CHAR_(ch1, ch2)) {
+    case PACK_CHAR_('h', 'h'): { length = kLengthChar;     fmt += 2; break; }
+    case PACK_CHAR_('h', ' '): { length = kLengthShort;    fmt += 1; break; }
+    case PACK_CHAR_('l', ' '): { length = kLengthLong;     fmt += 1; break; }
+    case PACK_CHAR_('l', 'l'): { length = kLengthLongLong; fmt += 2; break; }
+    case PACK_CHAR_('j', ' '): { length = kLengthIntMaxT;  fmt += 1; break; }
+    case PACK_CHAR_('z', ' '): { length = kLengthSizeT;    fmt += 1; break; }
+    case PACK_CHAR_('t', ' '): { length = kLengthPtrDiffT; fmt += 1; break; }
+    case PACK_CHAR_('p', ' '): { length = kLengthVoidP;              break; }
+  }
+
+# undef PACK_CHAR_
+
+  conv->length = length;
+  return fmt;
+}
+
+/* Hashes a custom conversion's name (FNV-1a) to a named_conversions[] slot. */
+static size_t hash_conversion_name(const char *name, size_t len) {
+  uint_least32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash = ((hash ^ (unsigned char)name[i]) * 16777619u) & 0xFFFFFFFFu;
+  }
+  return hash % NAMED_CONVERSION_MAX;
+}
+
+/*
+ * Parses a "{name}" for a named custom conversion, if present.  This leaves
+ * fmt pointing at the closing '}', which then acts as the conversion type.  An
+ * unregistered name leaves conv->named NULL, so the conversion fails and the
+ * whole spec prints as-is.
+ */
+static const char *parse_name(const char *fmt, struct conv *restrict conv) {
+  if (*fmt != '{') { return fmt; }
+
+  const char *name = fmt + 1;
+  const char *end = strchr(name, '}');
+  if (!end) { return fmt; }  /* Unterminated, so it's just an invalid '{'. */
+
+  const size_t len = end - name;
+  if (len >= NAMED_CONVERSION_LEN) { return end; }
+
+  /* Probe linearly from the name's hash.  Tables are never full. */
+  for (size_t i = hash_conversion_name(name, len);;
+       i = (i + 1) % NAMED_CONVERSION_MAX) {
+    struct named_conversion *nc = &named_conversions[i];
+    if (!atomic_load_explicit(&nc->fn, memory_order_acquire)) { break; }
+    if (!memcmp(nc->name, name, len) && !nc->name[len]) {
+      conv->named = nc;
+      break;
+    }
+  }
+
+  return end;
+}
+
+
+/*******************************************************************************
+ * Format conversions
+ ******************************************************************************/
+
+/*
+ * Built-in conversions, indexed by conversion type.  Each takes the conversion
+ * spec and prints it, returning true on success.
+ */
+typedef bool conversion_fn(struct conv *restrict conv);
+
+static conversion_fn *const builtin_conversions[UCHAR_MAX + 1] = {
+  ['n'] = store_character_count,
+  ['c'] = print_char_conversion,
+  ['='] = print_fill_conversion,
+  ['s'] = print_string_conversion,
+  ['V'] = print_iovec_conversion,
+  ['R'] = print_reader_conversion,
+  ['J'] = print_json_conversion,
+  ['q'] = print_quoted_conversion,
+  ['Q'] = print_csv_conversion,
+  ['U'] = print_url_conversion,
+  ['r'] = print_hex_conversion,
+  ['Y'] = print_base64_conversion,
+  ['y'] = print_base32_conversion,
+  ['T'] = print_time_conversion,
+  ['N'] = print_duration_conversion,
+  ['K'] = print_size_conversion,
+  ['I'] = print_ip_conversion,
+  ['M'] = print_mac_conversion,
+  ['W'] = print_uuid_conversion,
+  ['m'] = print_errno_conversion,
+  ['P'] = print_identity_conversion,
+  ['}'] = print_named_conversion,
+  ['d'] = print_diouxXp_conversions, ['i'] = print_diouxXp_conversions,
+  ['u'] = print_diouxXp_conversions, ['o'] = print_diouxXp_conversions,
+  ['x'] = print_diouxXp_conversions, ['X'] = print_diouxXp_conversions,
+  ['p'] = print_diouxXp_conversions,
+};
+
+/*
+ * Dispatches to appropriate conversion and prints. Returns true on success.
+ * Built-in conversions come first, then any custom conversion registered for
+ * the letter.
+ */
+static bool print_conversion(struct conv *restrict conv) {
+  const unsigned char type = conv->type;
+
+  if (builtin_conversions[type]) { return builtin_conversions[type](conv); }
+
+  simple_conversion_fn *const fn =
+      atomic_load_explicit(&custom_conversions[type], memory_order_acquire);
+
+  return fn && fn(conv, conv->printer);  /* Or not a supported conversion. */
+}
+
+/* Prints "{name}" conversions, via the custom conversion parse_name found. */
+static bool print_named_conversion(struct conv *restrict conv) {
+  if (!conv->named) { return false; }
+
+  simple_conversion_fn *const fn =
+      atomic_load_explicit(&conv->named->fn, memory_order_relaxed);
+
+  return fn(conv, conv->printer);
+}
+
+/* Prints %c and %lc conversions. */
+static bool print_char_conversion(struct conv *restrict conv) {
+  if (conv->length == kLengthLong) {  /* %lc:  Encode the wint_t as UTF-8. */
+    char buf[4];
+    const int len = encode_utf8(va_arg(*conv->args, wint_t), buf);
+    return print_converted_string(conv, buf, len);
+  }
+
+  if (conv->length != kLengthDefault) { return false; }
+
+  char c = (unsigned char)va_arg(*conv->args, int);
+  return print_converted_string(conv, &c, 1);
+}
+
+/*
+ * Prints %= and %l= conversions:  the character argument, repeated as many
+ * times as the width says.  The width is a count here, not a field size, so
+ * there's no padding.  A negative count, from '*' or the '-' flag, prints
+ * nothing.  Single bytes go through the printer's fill(), and multi-byte
+ * characters go out in chunks of repeats.
+ */
+static bool print_fill_conversion(struct conv *restrict conv) {
+  struct printer *const p = conv->printer;
+  size_t count = conv->left_justify ? 0 : (size_t)conv->width;
+
+  if (conv->length == kLengthDefault) {
+    p->fill(p, (char)va_arg(*conv->args, int), count);
+    return true;
+  }
+
+  if (conv->length != kLengthLong) { return false; }
+
+  char chunk[256];
+  const int len = encode_utf8(va_arg(*conv->args, wint_t), chunk);
+  if (len == 1) { p->fill(p, chunk[0], count); return true; }
+
+  const size_t per_chunk = count < sizeof(chunk) / len ? count
+                                                        : sizeof(chunk) / len;
+  for (size_t i = 1; i < per_chunk; i++) {
+    memcpy(chunk + i * len, chunk, len);
+  }
+
+  for (; count > per_chunk; count -= per_chunk) {
+    p->copy(p, chunk, chunk + per_chunk * len);
+  }
+  p->copy(p, chunk, chunk + count * len);
+  return true;
+}
+
+/*
+ * Prints %s conversions, truncating the string if needed.  With the "'" flag,
+ * the precision counts UTF-8 characters, and we read no further than that.
+ */
+static bool print_string_conversion(struct conv *restrict conv) {
+  if (conv->length == kLengthLong)  { return print_wide_string(conv);  }
+  if (conv->length == kLengthSizeT) { return print_string_slice(conv); }
+  if (conv->length != kLengthDefault) { return false; }
+
+  const size_t      max_len = conv->explicit_prec ? conv->prec : SIZE_MAX;
+  const char *const str     = va_arg(*conv->args, const char *);
+
+  /*
+   * If we don't need the length before printing the string, let the printer
+   * find the null as it copies, rather than scanning the string twice.
+   */
+  if (!conv->count_chars && (conv->left_justify || !conv->width)) {
+    struct printer *restrict p = conv->printer;
+    const size_t str_len = p->copy_str(p, str, max_len);
+    const size_t fill_count = pad_width(conv, str_len);
+    if (fill_count) { p->fill(p, ' ', fill_count); }
+    return true;
+  }
+
+  if (conv->count_chars && conv->explicit_prec) {
+    const size_t str_len = utf8_prefix_length(str, conv->prec);
+    return print_converted_string(conv, str, str_len);
+  }
+
+  const char *const end     = memchr(str, '\0', max_len);
+  const size_t      str_len = end ? (size_t)(end - str) : max_len;
+
+  return print_converted_string(conv, str, str_len);
+}
+
+/*
+ * Prints %zs conversions:  exactly as many bytes as the size_t argument says,
+ * nulls and all, without scanning.  Precision can still truncate the slice.
+ */
+static bool print_string_slice(struct conv *restrict conv) {
+  size_t            str_len = va_arg(*conv->args, size_t);
+  const char *const str     = va_arg(*conv->args, const char *);
+
+  if (conv->count_chars && conv->explicit_prec) {
+    str_len = skip_utf8_chars(str, str_len, conv->prec);
+  } else if (conv->explicit_prec && str_len > (size_t)conv->prec) {
+    str_len = conv->prec;
+  }
+
+  return print_converted_string(conv, str, str_len);
+}
+
+/*
+ * Prints %V conversions:  the segments of an iovec array, back to back, as
+ * one logical string.  Width and precision apply to the string as a whole.
+ */
+static bool print_iovec_conversion(struct conv *restrict conv) {
+  const struct iovec *const iov     = va_arg(*conv->args, const struct iovec *);
+  const int                 iov_cnt = va_arg(*conv->args, int);
+  const size_t max_len = conv->explicit_prec ? conv->prec : SIZE_MAX;
+  struct printer *restrict p = conv->printer;
+
+  size_t str_len = 0;
+  for (int i = 0; i < iov_cnt && str_len < max_len; i++) {
+    const size_t room = max_len - str_len;
+    str_len += iov[i].iov_len < room ? iov[i].iov_len : room;
+  }
+
+  const size_t fill_count = pad_width(conv, str_len);
+
+  if (!conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  size_t remain = str_len;
+  for (int i = 0; remain; i++) {
+    const char *const seg     = iov[i].iov_base;
+    const size_t      seg_len = iov[i].iov_len < remain ? iov[i].iov_len
+                                                        : remain;
+    if (seg_len) { p->copy(p, seg, seg + seg_len); }
+    remain -= seg_len;
+  }
+
+  if ( conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  return true;
+}
+
+/* Size of the chunks we pull from a struct simple_reader. */
+#define READER_BUF_SIZE (256)
+
+/*
+ * Prints %R conversions, pulling text from the reader a chunk at a time.
+ * Precision limits the total number of bytes we ask it for.
+ */
+static bool print_reader_conversion(struct conv *restrict conv) {
+  const struct simple_reader *const r =
+      va_arg(*conv->args, const struct simple_reader *);
+  const size_t max_len = conv->explicit_prec ? conv->prec : SIZE_MAX;
+  struct printer *restrict p = conv->printer;
+
+  /* Right justification needs the length up front. */
+  if (!conv->left_justify && conv->width && r->size) {
+    const size_t size    = r->size(r->ctx);
+    const size_t str_len = size < max_len ? size : max_len;
+    const size_t fill_count = pad_width(conv, str_len);
+    if (fill_count) { p->fill(p, ' ', fill_count); }
+  }
+
+  char buf[READER_BUF_SIZE];
+  size_t str_len = 0, chunk_len;
+  do {
+    const size_t room = max_len - str_len;
+    chunk_len = r->read(r->ctx, buf, room < sizeof(buf) ? room : sizeof(buf));
+    if (chunk_len) { p->copy(p, buf, buf + chunk_len); }
+    str_len += chunk_len;
+  } while (chunk_len && str_len < max_len);
+
+  const size_t fill_count = pad_width(conv, str_len);
+  if ((conv->left_justify || !r->size) && fill_count) {
+    p->fill(p, ' ', fill_count);
+  }
+
+  return true;
+}
+
+/* Prints %J conversions:  a string escaped for use in a JSON string. */
+static bool print_json_conversion(struct conv *restrict conv) {
+  const char *str;
+  size_t str_len;
+  if (!get_string_argument(conv, &str, &str_len)) { return false; }
+
+  const char quote = conv->is_alt ? '"' : '\0';
+  return print_escaped_string(conv, &json_style, quote, str, str_len);
+}
+
+/*
+ * Prints %q conversions:  a string as a double-quoted C literal, or with "#",
+ * quoted as $'...' for a POSIX shell.
+ */
+static bool print_quoted_conversion(struct conv *restrict conv) {
+  const char *str;
+  size_t str_len;
+  if (!get_string_argument(conv, &str, &str_len)) { return false; }
+
+  return conv->is_alt
+      ? print_escaped_string(conv, &shell_style, '\'', str, str_len)
+      : print_escaped_string(conv, &c_style,     '"',  str, str_len);
+}
+
+/* Fields that quote into this many bytes or fewer get built on the stack. */
+#define CSV_BUF_SIZE (256)
+
+/*
+ * Prints %Q conversions:  a string as a CSV field.  Per RFC 4180, a field
+ * only needs quotes if it holds a quote, comma or line break, and quotes
+ * within it get doubled.  With "#", prints a TSV field instead, which has no
+ * quoting and escapes tabs, line breaks, and backslashes.
+ *
+ * Fields are short, as a rule, so this avoids the general escaping path's
+ * extra scans and per-run copies.  A plain string gets its length and first
+ * special byte from one strcspn() call.  A field that needs no quotes goes
+ * out in one copy, and a quoted field that fits in CSV_BUF_SIZE gets built
+ * on the stack, quotes and all, and goes out in one copy too.
+ */
+static bool print_csv_conversion(struct conv *restrict conv) {
+  const char *str, *hit;
+  size_t str_len;
+
+  if (!conv->is_alt && !conv->explicit_prec &&
+      conv->length == kLengthDefault) {
+    str = va_arg(*conv->args, const char *);
+    hit = str + strcspn(str, "\",\n\r");
+    str_len = *hit ? (size_t)(hit - str) + strlen(hit) : (size_t)(hit - str);
+  } else {
+    if (!get_string_argument(conv, &str, &str_len)) { return false; }
+
+    if (conv->is_alt) {
+      return print_escaped_string(conv, &tsv_style, '\0', str, str_len);
+    }
+
+    hit = find_escape(&csv_style, str, str + str_len);
+  }
+
+  const char *const end = str + str_len;
+  struct printer *restrict p = conv->printer;
+
+  /* Quoting only ever doubles a byte, so this bounds the quoted length. */
+  const bool fits = str_len <= (CSV_BUF_SIZE - 2) / 2;
+  if (hit != end && !fits) {
+    return print_escaped_string(conv, &csv_quoted_style, '"', str, str_len);
+  }
+
+  const char *out     = str;
+  size_t      out_len = str_len;
+  char        buf[CSV_BUF_SIZE];
+
+  if (hit != end) {  /* Quote it.  Precision limits what's inside quotes. */
+    const size_t max_len = conv->explicit_prec ? conv->prec : SIZE_MAX;
+    size_t idx = 1;
+    buf[0] = '"';
+    memcpy(buf + idx, str, hit - str);
+    idx += hit - str;
+    for (const char *s = hit; s != end && idx - 1 < max_len; s++) {
+      if (*s == '"') {
+        if (max_len - (idx - 1) < 2) { break; }  /* Don't split the "". */
+        buf[idx++] = '"';
+      }
+      buf[idx++] = *s;
+    }
+    buf[idx++] = '"';
+    out     = buf;
+    out_len = idx;
+  }
+
+  const size_t fill_count = pad_width(conv, out_len);
+  if (!conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+  p->copy(p, out, out + out_len);
+  if ( conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  return true;
+}
+
+/* How percent-encoding treats each byte. */
+enum {
+  kUrlOther      = 0,   /* Always encoded.                               */
+  kUrlReserved   = 1,   /* Delimiters:  Encoded unless asked not to.     */
+  kUrlUnreserved = 2    /* Letters, digits, "-._~":  Never encoded.      */
+};
+
+/*
+ * Prints %U conversions:  a string percent-encoded per RFC 3986.  By default
+ * this encodes everything but unreserved characters, suiting a single query
+ * parameter or path segment.  With "#", it leaves reserved characters alone,
+ * suiting an entire URL.  Precision limits the input bytes encoded, and the
+ * width applies to the encoded output.
+ */
+static bool print_url_conversion(struct conv *restrict conv) {
+  const char *str;
+  size_t str_len;
+  if (!get_string_argument(conv, &str, &str_len)) { return false; }
+
+  const char *const   end  = str + str_len;
+  const unsigned char keep = conv->is_alt ? kUrlReserved : kUrlUnreserved;
+  struct printer *restrict p = conv->printer;
+
+  size_t out_len = 0;
+  if (!conv->left_justify && conv->width) {
+    out_len = encode_url(str, end, keep, NULL);
+    const size_t fill_count = pad_width(conv, out_len);
+    if (fill_count) { p->fill(p, ' ', fill_count); }
+  }
+
+  out_len = encode_url(str, end, keep, p);
+
+  const size_t fill_count = pad_width(conv, out_len);
+  if (conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  return true;
+}
+
+/*
+ * Prints %r conversions:  a buffer of bytes in hex.  The " " flag puts a
+ * space between groups of bytes, with precision setting the group size.
+ * With "#", prints a multi-line dump instead, like xxd, which ignores width.
+ */
+static bool print_hex_conversion(struct conv *restrict conv) {
+  const unsigned char *const data = va_arg(*conv->args, const void *);
+  const size_t               len  = va_arg(*conv->args, size_t);
+  struct printer *restrict   p    = conv->printer;
+
+  const bool   sep   = conv->sign == kSignSpace;
+  const size_t group = conv->explicit_prec && conv->prec ? conv->prec
+                     : conv->is_alt                      ? 2
+                     :                                     1;
+
+  if (conv->is_alt) { print_hex_dump(p, data, len, group); return true; }
+
+  const size_t out_len = 2 * len + (sep && len ? (len - 1) / group : 0);
+  const size_t fill_count = pad_width(conv, out_len);
+
+  if (!conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+  print_hex_bytes(p, data, len, sep ? group : 0);
+  if ( conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  return true;
+}
+
+/* Digits for base64 (RFC 4648):  standard and URL-safe alphabets. */
+static const char base64_digits[2][65] = {
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+};
+
+/* Digits for base32 (RFC 4648):  standard and "extended hex" alphabets. */
+static const char base32_digits[2][33] = {
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567", "0123456789ABCDEFGHIJKLMNOPQRSTUV"
+};
+
+/* Prints %Y conversions:  a buffer of bytes in base64. */
+static bool print_base64_conversion(struct conv *restrict conv) {
+  return print_base_n(conv, base64_digits[conv->is_alt], 6);
+}
+
+/* Prints %y conversions:  a buffer of bytes in base32. */
+static bool print_base32_conversion(struct conv *restrict conv) {
+  return print_base_n(conv, base32_digits[conv->is_alt], 5);
+}
+
+/*
+ * Prints %ls conversions as UTF-8.  Precision counts output bytes, and we
+ * never split a character to honor it.  Right justification needs the encoded
+ * length up front, so in that case we encode twice:  once to measure, and
+ * once to print.
+ */
+static bool print_wide_string(struct conv *restrict conv) {
+  const size_t         max_len = conv->explicit_prec ? conv->prec : SIZE_MAX;
+  const wchar_t *const ws      = va_arg(*conv->args, const wchar_t *);
+  struct printer *restrict p   = conv->printer;
+
+  /*
+   * With a precision, the array needn't have a null, so we can't scan ahead
+   * for one.  The encoder finds it as it goes.
+   */
+  const size_t ws_len = conv->explicit_prec ? SIZE_MAX : wcslen(ws);
+
+  size_t str_len = 0;
+  if (!conv->left_justify && conv->width) {
+    str_len = encode_wide_string(ws, ws_len, max_len, NULL);
+    const size_t fill_count = pad_width(conv, str_len);
+    if (fill_count) { p->fill(p, ' ', fill_count); }
+  }
+
+  str_len = encode_wide_string(ws, ws_len, max_len, p);
+
+  const size_t fill_count = pad_width(conv, str_len);
+  if (conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  return true;
+}
+
+/*
+ * Buffer size for converting integers.  This should be enough for a 128-bit
+ * intmax_t, with sign or 0x prefix and terminating null, with some extra room.
+ * My current platform only has a 64-bit intmax_t, however, so 128-bit is
+ * not tested.
+ */
+#define INT_BUF_SIZE (48)
+
+/* Prints various integer conversions. */
+static bool print_diouxXp_conversions(struct conv *restrict conv) {
+  char buf[INT_BUF_SIZE];
+  conv->is_signed = false;  /* default. */
+
+  switch (conv->type) {
+    case 'd': { conv->is_signed = true;                break; }  /* signed   */
+    case 'i': { conv->is_signed = true;                break; }  /* signed   */
+    case 'u': {                                        break; }  /* unsigned */
+    case 'o': { conv->base = 8;                        break; }  /* octal    */
+    case 'x': { conv->base = 16;                       break; }  /* hex      */
+    case 'X': { conv->base = 16; conv->is_caps = true; break; }  /* HEX      */
+    case 'p': { conv->base = 16; conv->is_alt = true;  break; }  /* (void *) */
+  }
+
+  if (!conv->explicit_prec) {
+    /*
+     * If provided an explicit non-zero width but no precision and asked to
+     * zero pad, treat the width like a "soft" precision that can be eaten
+     * into by the sign and a radix prefix if needed.
+     */
+    if (conv->leading_zero && conv->explicit_width && conv->width &&
+        !conv->left_justify) {
+      conv->prec      = conv->width;
+      conv->soft_prec = true;
+    } else {
+      conv->prec = 1;
+    }
+  }
+
+  const uintmax_t value = conv->is_signed ? get_signed_integer(conv)
+                                          : get_unsigned_integer(conv);
+  const int idx         = convert_integer_to_string(value, conv, buf);
+  const int str_len     = INT_BUF_SIZE - idx - 1;
+
+  /*
+   * The buffer only holds so many leading zeros.  Past that, print the sign
+   * or "0x", then the rest of the zeros with fill(), then what's left.
+   */
+  const bool has_sign   = buf[idx] == '-' || buf[idx] == '+' || buf[idx] == ' ';
+  const int  prefix_len = conv->is_alt && conv->base == 16 ? 2 : has_sign;
+  const int  more_zeros = str_len ? conv->prec - (str_len - prefix_len) : 0;
+  if (more_zeros <= 0) {
+    return print_converted_string(conv, buf + idx, str_len);
+  }
+
+  struct printer *restrict p = conv->printer;
+  const size_t total      = (size_t)str_len + more_zeros;
+  const size_t fill_count = pad_width(conv, total);
+
+  if (!conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+  p->copy(p, buf + idx, buf + idx + prefix_len);
+  p->fill(p, '0', more_zeros);
+  p->copy(p, buf + idx + prefix_len, buf + idx + str_len);
+  if ( conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  return true;
+}
+
+/* Default digits of fractional seconds in timestamps:  microseconds. */
+#define TIME_DEFAULT_PREC (6)
+
+/*
+ * Prints %T conversions:  a UTC timestamp such as 2023-07-20T12:34:56.789012Z.
+ * The date and time come from a per-thread cache that only changes once per
+ * second, so most calls only have to convert the fractional seconds.
+ */
+static bool print_time_conversion(struct conv *restrict conv) {
+  intmax_t sec, nsec;
+
+  if (conv->length == kLengthIntMaxT) {
+    const intmax_t ns = va_arg(*conv->args, intmax_t);
+    sec  = ns / 1000000000;
+    nsec = ns % 1000000000;
+    if (nsec < 0) { nsec += 1000000000; sec--; }  /* Round toward -infinity. */
+  } else if (conv->length == kLengthDefault) {
+    const struct timespec *const ts =
+        va_arg(*conv->args, const struct timespec *);
+    sec  = ts->tv_sec;
+    nsec = ts->tv_nsec;
+  } else {
+    return false;
+  }
+
+  const int frac_digits = !conv->explicit_prec ? TIME_DEFAULT_PREC
+                        : conv->prec > 9       ? 9
+                        :                        conv->prec;
+
+  /* Room for the date and time, '.', 9 digits, 'Z', and an oversized year. */
+  char buf[48];
+  const char *const date_time = format_date_time(sec);
+  size_t len = strlen(date_time);
+  memcpy(buf, date_time, len);
+  if (conv->is_alt) { buf[len - 9] = ' '; }  /* RFC 3339 permits a space. */
+
+  if (frac_digits) {
+    char int_buf[INT_BUF_SIZE];
+    struct conv frac = { .base = 10, .prec = 9 };
+    const int idx = convert_integer_to_string(nsec, &frac, int_buf);
+
+    buf[len++] = '.';
+    memcpy(buf + len, int_buf + idx, frac_digits);
+    len += frac_digits;
+  }
+  buf[len++] = 'Z';
+
+  return print_converted_string(conv, buf, len);
+}
+
+/* Most significant digits in a humanized quantity:  all a uint64_t holds. */
+#define HUMANIZED_MAX_SIG (19)
+
+/* A unit for humanized quantities, and how many base units it holds. */
+struct unit {
+  uint64_t    size;
+  const char *name;
+};
+
+static const struct unit duration_units[] = {
+  { 1, "ns" }, { 1000, "us" }, { 1000000, "ms" }, { 1000000000, "s" }
+};
+
+static const struct unit size_units[2][7] = {
+  { { 1, " B" }, { 1ULL << 10, " KiB" }, { 1ULL << 20, " MiB" },
+    { 1ULL << 30, " GiB" }, { 1ULL << 40, " TiB" }, { 1ULL << 50, " PiB" },
+    { 1ULL << 60, " EiB" } },
+  { { 1, " B" }, { 1000ULL, " kB" }, { 1000000ULL, " MB" },
+    { 1000000000ULL, " GB" }, { 1000000000000ULL, " TB" },
+    { 1000000000000000ULL, " PB" }, { 1000000000000000000ULL, " EB" } }
+};
+
+/*
+ * Prints a quantity in the largest unit it has at least one of.  Precision
+ * gives the number of significant digits, though we never drop digits from
+ * the integer part, and whole base units never get a fractional part.  The
+ * last digit rounds half up.  If that carries into a whole next unit, as in
+ * 999.95ms, we move up to that unit and print 1.000s instead.  Precision
+ * caps at HUMANIZED_MAX_SIG.
+ */
+static bool print_humanized(struct conv *restrict conv, uint64_t value,
+                            const struct unit *units, int num_units,
+                            int default_sig) {
+  const int sig = !conv->explicit_prec           ? default_sig
+                : conv->prec < 1                 ? 1
+                : conv->prec > HUMANIZED_MAX_SIG ? HUMANIZED_MAX_SIG
+                :                                  conv->prec;
+
+  int u = 0;
+  while (u + 1 < num_units && value >= units[u + 1].size) { u++; }
+
+  uint64_t digits;   /* All the digits we'll print, without the '.'. */
+  int frac_digits;
+
+  for (;;) {
+    const uint64_t size  = units[u].size;
+    uint64_t       whole = value / size;
+    uint64_t       rem   = value % size;
+
+    int whole_digits = 1;
+    for (uint64_t w = whole; w >= 10; w /= 10) { whole_digits++; }
+
+    frac_digits = u > 0 && sig > whole_digits ? sig - whole_digits : 0;
+
+    /* Long division, a digit at a time, so nothing overflows. */
+    digits = whole;
+    for (int i = 0; i < frac_digits; i++) {
+      rem *= 10;
+      digits = digits * 10 + rem / size;
+      rem %= size;
+    }
+
+    if (rem >= size - rem) { digits++; }  /* Round half up. */
+
+    /* Did rounding carry us into a whole next unit? */
+    uint64_t pow10 = 1;
+    for (int i = 0; i < frac_digits; i++) { pow10 *= 10; }
+
+    if (u + 1 < num_units &&
+        digits / pow10 >= units[u + 1].size / units[u].size) {
+      u++;
+      continue;
+    }
+
+    break;
+  }
+
+  /* Convert the digits, then insert the '.' before the fractional part. */
+  char int_buf[INT_BUF_SIZE];
+  struct conv int_conv = { .base = 10, .prec = frac_digits + 1 };
+  const int    idx     = convert_integer_to_string(digits, &int_conv, int_buf);
+  const size_t int_len = INT_BUF_SIZE - idx - 1 - frac_digits;
+
+  char buf[INT_BUF_SIZE + 8];
+  size_t len = int_len;
+  memcpy(buf, int_buf + idx, int_len);
+
+  if (frac_digits) {
+    buf[len++] = '.';
+    memcpy(buf + len, int_buf + idx + int_len, frac_digits);
+    len += frac_digits;
+  }
+
+  const size_t name_len = strlen(units[u].name);
+  memcpy(buf + len, units[u].name, name_len);
+  len += name_len;
+
+  return print_converted_string(conv, buf, len);
+}
+
+/* Prints %N conversions:  a uint64_t count of nanoseconds, humanized. */
+static bool print_duration_conversion(struct conv *restrict conv) {
+  const uint64_t ns = va_arg(*conv->args, uint64_t);
+  return print_humanized(conv, ns, duration_units, 4, 4);
+}
+
+/*
+ * Prints %K conversions:  a uint64_t count of bytes, humanized with binary
+ * units, or with "#", decimal units.
+ */
+static bool print_size_conversion(struct conv *restrict conv) {
+  const uint64_t bytes = va_arg(*conv->args, uint64_t);
+  return print_humanized(conv, bytes, size_units[conv->is_alt], 7, 3);
+}
+
+/*
+ * Prints %I conversions:  an IPv4 address, or with "l", an IPv6 address.
+ * Each address gets formatted in a buffer and goes out in one copy.
+ */
+static bool print_ip_conversion(struct conv *restrict conv) {
+  if (conv->length != kLengthDefault && conv->length != kLengthLong) {
+    return false;
+  }
+
+  const unsigned char *const addr = va_arg(*conv->args, const void *);
+  char buf[48];  /* Longest IPv6 form is 45 characters. */
+  const int len = conv->length == kLengthLong ? format_ipv6(addr, buf)
+                                              : format_ipv4(addr, buf);
+  return print_converted_string(conv, buf, len);
+}
+
+/* Prints %M conversions:  a MAC address, as in 00:1a:2b:3c:4d:5e. */
+static bool print_mac_conversion(struct conv *restrict conv) {
+  static const int fields[6] = { 1, 1, 1, 1, 1, 1 };
+  const unsigned char *const addr = va_arg(*conv->args, const void *);
+  char buf[24];
+  const int len = format_hex_fields(addr, fields, 6, ':', buf);
+  return print_converted_string(conv, buf, len);
+}
+
+/* Prints %W conversions:  a UUID, in the usual 8-4-4-4-12 hex digit form. */
+static bool print_uuid_conversion(struct conv *restrict conv) {
+  static const int fields[5] = { 4, 2, 2, 2, 6 };
+  const unsigned char *const uuid = va_arg(*conv->args, const void *);
+  char buf[40];
+  const int len = format_hex_fields(uuid, fields, 5, '-', buf);
+  return print_converted_string(conv, buf, len);
+}
+
+/* An errno value's symbolic name and message. */
+struct errno_entry {
+  const char *name;
+  const char *message;
+};
+
+#define ERRNO_ENTRY_(e, msg) [e] = { #e, msg }
+
+/*
+ * Names and messages for the errno values POSIX defines, indexed by value.
+ * The messages match glibc's in the C locale.  Some values are aliases on
+ * some systems, and some are optional.
+ */
+static const struct errno_entry errno_table[] = {
+  [0] = { "0", "Success" },
+  ERRNO_ENTRY_(E2BIG, "Argument list too long"),
+  ERRNO_ENTRY_(EACCES, "Permission denied"),
+  ERRNO_ENTRY_(EADDRINUSE, "Address already in use"),
+  ERRNO_ENTRY_(EADDRNOTAVAIL, "Cannot assign requested address"),
+  ERRNO_ENTRY_(EAFNOSUPPORT, "Address family not supported by protocol"),
+  ERRNO_ENTRY_(EAGAIN, "Resource temporarily unavailable"),
+  ERRNO_ENTRY_(EALREADY, "Operation already in progress"),
+  ERRNO_ENTRY_(EBADF, "Bad file descriptor"),
+  ERRNO_ENTRY_(EBADMSG, "Bad message"),
+  ERRNO_ENTRY_(EBUSY, "Device or resource busy"),
+  ERRNO_ENTRY_(ECANCELED, "Operation canceled"),
+  ERRNO_ENTRY_(ECHILD, "No child processes"),
+  ERRNO_ENTRY_(ECONNABORTED, "Software caused connection abort"),
+  ERRNO_ENTRY_(ECONNREFUSED, "Connection refused"),
+  ERRNO_ENTRY_(ECONNRESET, "Connection reset by peer"),
+  ERRNO_ENTRY_(EDEADLK, "Resource deadlock avoided"),
+  ERRNO_ENTRY_(EDESTADDRREQ, "Destination address required"),
+  ERRNO_ENTRY_(EDOM, "Numerical argument out of domain"),
+  ERRNO_ENTRY_(EDQUOT, "Disk quota exceeded"),
+  ERRNO_ENTRY_(EEXIST, "File exists"),
+  ERRNO_ENTRY_(EFAULT, "Bad address"),
+  ERRNO_ENTRY_(EFBIG, "File too large"),
+  ERRNO_ENTRY_(EHOSTUNREACH, "No route to host"),
+  ERRNO_ENTRY_(EIDRM, "Identifier removed"),
+  ERRNO_ENTRY_(EILSEQ, "Invalid or incomplete multibyte or wide character"),
+  ERRNO_ENTRY_(EINPROGRESS, "Operation now in progress"),
+  ERRNO_ENTRY_(EINTR, "Interrupted system call"),
+  ERRNO_ENTRY_(EINVAL, "Invalid argument"),
+  ERRNO_ENTRY_(EIO, "Input/output error"),
+  ERRNO_ENTRY_(EISCONN, "Transport endpoint is already connected"),
+  ERRNO_ENTRY_(EISDIR, "Is a directory"),
+  ERRNO_ENTRY_(ELOOP, "Too many levels of symbolic links"),
+  ERRNO_ENTRY_(EMFILE, "Too many open files"),
+  ERRNO_ENTRY_(EMLINK, "Too many links"),
+  ERRNO_ENTRY_(EMSGSIZE, "Message too long"),
+#ifdef EMULTIHOP
+  ERRNO_ENTRY_(EMULTIHOP, "Multihop attempted"),
+#endif
+  ERRNO_ENTRY_(ENAMETOOLONG, "File name too long"),
+  ERRNO_ENTRY_(ENETDOWN, "Network is down"),
+  ERRNO_ENTRY_(ENETRESET, "Network dropped connection on reset"),
+  ERRNO_ENTRY_(ENETUNREACH, "Network is unreachable"),
+  ERRNO_ENTRY_(ENFILE, "Too many open files in system"),
+  ERRNO_ENTRY_(ENOBUFS, "No buffer space available"),
+#ifdef ENODATA
+  ERRNO_ENTRY_(ENODATA, "No data available"),
+#endif
+  ERRNO_ENTRY_(ENODEV, "No such device"),
+  ERRNO_ENTRY_(ENOENT, "No such file or directory"),
+  ERRNO_ENTRY_(ENOEXEC, "Exec format error"),
+  ERRNO_ENTRY_(ENOLCK, "No locks available"),
+#ifdef ENOLINK
+  ERRNO_ENTRY_(ENOLINK, "Link has been severed"),
+#endif
+  ERRNO_ENTRY_(ENOMEM, "Cannot allocate memory"),
+  ERRNO_ENTRY_(ENOMSG, "No message of desired type"),
+  ERRNO_ENTRY_(ENOPROTOOPT, "Protocol not available"),
+  ERRNO_ENTRY_(ENOSPC, "No space left on device"),
+#ifdef ENOSR
+  ERRNO_ENTRY_(ENOSR, "Out of streams resources"),
+#endif
+#ifdef ENOSTR
+  ERRNO_ENTRY_(ENOSTR, "Device not a stream"),
+#endif
+  ERRNO_ENTRY_(ENOSYS, "Function not implemented"),
+  ERRNO_ENTRY_(ENOTCONN, "Transport endpoint is not connected"),
+  ERRNO_ENTRY_(ENOTDIR, "Not a directory"),
+  ERRNO_ENTRY_(ENOTEMPTY, "Directory not empty"),
+  ERRNO_ENTRY_(ENOTRECOVERABLE, "State not recoverable"),
+  ERRNO_ENTRY_(ENOTSOCK, "Socket operation on non-socket"),
+#if ENOTSUP != EOPNOTSUPP
+  ERRNO_ENTRY_(ENOTSUP, "Operation not supported"),
+#endif
+  ERRNO_ENTRY_(ENOTTY, "Inappropriate ioctl for device"),
+  ERRNO_ENTRY_(ENXIO, "No such device or address"),
+  ERRNO_ENTRY_(EOPNOTSUPP, "Operation not supported"),
+  ERRNO_ENTRY_(EOVERFLOW, "Value too large for defined data type"),
+  ERRNO_ENTRY_(EOWNERDEAD, "Owner died"),
+  ERRNO_ENTRY_(EPERM, "Operation not permitted"),
+  ERRNO_ENTRY_(EPIPE, "Broken pipe"),
+  ERRNO_ENTRY_(EPROTO, "Protocol error"),
+  ERRNO_ENTRY_(EPROTONOSUPPORT, "Protocol not supported"),
+  ERRNO_ENTRY_(EPROTOTYPE, "Protocol wrong type for socket"),
+  ERRNO_ENTRY_(ERANGE, "Numerical result out of range"),
+  ERRNO_ENTRY_(EROFS, "Read-only file system"),
+  ERRNO_ENTRY_(ESPIPE, "Illegal seek"),
+  ERRNO_ENTRY_(ESRCH, "No such process"),
+  ERRNO_ENTRY_(ESTALE, "Stale file handle"),
+#ifdef ETIME
+  ERRNO_ENTRY_(ETIME, "Timer expired"),
+#endif
+  ERRNO_ENTRY_(ETIMEDOUT, "Connection timed out"),
+  ERRNO_ENTRY_(ETXTBSY, "Text file busy"),
+#if EWOULDBLOCK != EAGAIN
+  ERRNO_ENTRY_(EWOULDBLOCK, "Resource temporarily unavailable"),
+#endif
+  ERRNO_ENTRY_(EXDEV, "Invalid cross-device link"),
+};
+
+#undef ERRNO_ENTRY_
+
+#define ERRNO_TABLE_SIZE ((int)(sizeof(errno_table) / sizeof(errno_table[0])))
+
+/*
+ * Prints %m conversions:  the message for the value errno had on entry to
+ * printf, or with "#", its symbolic name.  These come from a static table,
+ * rather than strerror(), so they never vary by locale or take a lock.
+ * Precision truncates, as for "s".
+ */
+static bool print_errno_conversion(struct conv *restrict conv) {
+  const int errnum = conv->errnum;
+  const char *str = NULL;
+
+  if (errnum >= 0 && errnum < ERRNO_TABLE_SIZE) {
+    str = conv->is_alt ? errno_table[errnum].name
+                       : errno_table[errnum].message;
+  }
+
+  /* Not in the table:  "Unknown error N", or just "N" for the name. */
+  char buf[INT_BUF_SIZE + 16];
+  if (!str) {
+    char int_buf[INT_BUF_SIZE];
+    struct conv int_conv = { .base = 10, .prec = 1, .is_signed = true };
+    const int idx = convert_integer_to_string(errnum, &int_conv, int_buf);
+    strcpy(buf, conv->is_alt ? "" : "Unknown error ");
+    strcat(buf, int_buf + idx);
+    str = buf;
+  }
+
+  size_t str_len = strlen(str);
+  if (conv->explicit_prec && str_len > (size_t)conv->prec) {
+    str_len = conv->prec;
+  }
+
+  return print_converted_string(conv, str, str_len);
+}
+
+/*
+ * Cached text for "P" conversions.  The process ID is the same for every
+ * thread, so it's rendered once, under pthread_once(), before any thread
+ * reads it.  Thread IDs and names are per thread, and each entry holds the
+ * rendered text, or a length of 0 if it needs filling in.  A fork changes
+ * the process ID, along with the thread ID of the thread that forked, so a
+ * pthread_atfork() handler fixes both in the child, which has one thread.
+ */
+struct identity_text {
+  int  len;
+  char text[INT_BUF_SIZE];
+};
+
+static struct identity_text              pid_text;
+static _Thread_local struct identity_text tid_text;
+static _Thread_local struct identity_text thread_name_text;
+
+static pthread_once_t identity_once = PTHREAD_ONCE_INIT;
+
+/* Renders an ID in decimal into a cache entry. */
+static void render_identity(struct identity_text *ident, intmax_t id) {
+  char int_buf[INT_BUF_SIZE];
+  struct conv int_conv = { .base = 10, .prec = 1, .is_signed = true };
+  const int idx = convert_integer_to_string(id, &int_conv, int_buf);
+  const int len = INT_BUF_SIZE - idx - 1;
+  memcpy(ident->text, int_buf + idx, len);
+  ident->len = len;
+}
+
+/* Refreshes cached identities that a fork changes, in the child. */
+static void identity_after_fork(void) {
+  render_identity(&pid_text, getpid());
+  tid_text.len = 0;
+}
+
+/* Renders the process ID and registers identity_after_fork(), once. */
+static void identity_init(void) {
+  render_identity(&pid_text, getpid());
+  pthread_atfork(NULL, NULL, identity_after_fork);
+}
+
+/*
+ * Prints %P conversions:  the process ID, or with "l", the thread ID, or with
+ * "#", the thread's name.  After the first use in each thread, each of these
+ * costs a single copy from the cache.
+ */
+static bool print_identity_conversion(struct conv *restrict conv) {
+  struct identity_text *ident;
+  pthread_once(&identity_once, identity_init);
+
+  if (conv->is_alt) {
+    ident = &thread_name_text;
+    if (!ident->len) {
+      if (pthread_getname_np(pthread_self(), ident->text,
+                             sizeof(ident->text))) {
+        ident->text[0] = '\0';
+      }
+      ident->len = strlen(ident->text);
+    }
+  } else if (conv->length == kLengthLong) {
+    ident = &tid_text;
+#ifdef SYS_gettid
+    if (!ident->len) { render_identity(ident, syscall(SYS_gettid)); }
+#endif
+    /* Else pthread_t is opaque, with no portable number:  print nothing. */
+  } else if (conv->length == kLengthDefault) {
+    ident = &pid_text;
+  } else {
+    return false;
+  }
+
+  return print_converted_string(conv, ident->text, ident->len);
+}
+
+/* Stores the current character count to the appropriate sort of pointer. */
+static bool store_character_count(struct conv *restrict conv) {
+  const uintmax_t t = conv->printer->total;
+
+  /* The length modifier determines the data type of the pointer argument. */
+  switch (conv->length) {
+    case kLengthChar:     { *va_arg(*conv->args, signed char *) = t; break; }
+    case kLengthShort:    { *va_arg(*conv->args, short *)       = t; break; }
+    case kLengthDefault:  { *va_arg(*conv->args, int *)         = t; break; }
+    case kLengthLong:     { *va_arg(*conv->args, long *)        = t; break; }
+    case kLengthLongLong: { *va_arg(*conv->args, long long *)   = t; break; }
+    case kLengthIntMaxT:  { *va_arg(*conv->args, intmax_t *)    = t; break; }
+    case kLengthSizeT:    { *va_arg(*conv->args, size_t *)      = t; break; }
+    case kLengthPtrDiffT: { *va_arg(*conv->args, ptrdiff_t *)   = t; break; }
+    /* Unknown:  Guess (int *). */
+    default:              { *va_arg(*conv->args, int *)         = t; break; }
+  }
+
+  return true;
+}
+
+
+/*******************************************************************************
+ * Integer argument fetchers
+ ******************************************************************************/
+
+/* Gets a signed argument of the specified size. */
+static uintmax_t get_signed_integer(struct conv *restrict conv) {
+  switch (conv->length) {
+    case kLengthChar:     { return (signed char )va_arg(*conv->args, int);   }
+    case kLengthShort:    { return (signed short)va_arg(*conv->args, int);   }
+    case kLengthDefault:  { return va_arg(*conv->args, int);                 }
+    case kLengthLong:     { return va_arg(*conv->args, long);                }
+    case kLengthLongLong: { return va_arg(*conv->args, long long);           }
+    case kLengthIntMaxT:  { return va_arg(*conv->args, intmax_t);            }
+    case kLengthSizeT:    { return va_arg(*conv->args, ssize_type);          }
+    case kLengthPtrDiffT: { return va_arg(*conv->args, ptrdiff_t);           }
+    case kLengthVoidP:    { return (uintptr_t)va_arg(*conv->args, void *);   }
+    /* Unknown:  Guess int. */
+    default:              { return va_arg(*conv->args, int);                 }
+  }
+}
+
+/* Gets an unsigned argument of the specified length. */
+static uintmax_t get_unsigned_integer(struct conv *restrict conv) {
+  switch (conv->length) {
+    case kLengthChar:     { return (unsigned char )va_arg(*conv->args, int); }
+    case kLengthShort:    { return (unsigned short)va_arg(*conv->args, int); }
+    case kLengthDefault:  { return va_arg(*conv->args, unsigned);            }
+    case kLengthLong:     { return va_arg(*conv->args, unsigned long);       }
+    case kLengthLongLong: { return va_arg(*conv->args, unsigned long long);  }
+    case kLengthIntMaxT:  { return va_arg(*conv->args, uintmax_t);           }
+    case kLengthSizeT:    { return va_arg(*conv->args, size_t);              }
+    case kLengthPtrDiffT: { return va_arg(*conv->args, uptrdiff_type);       }
+    case kLengthVoidP:    { return (uintptr_t)va_arg(*conv->args, void *);   }
+    /* Unknown:  Guess unsigned. */
+    default:              { return va_arg(*conv->args, unsigned);            }
+  }
+}
+
+/*
+ * Gets a string argument for conversions that take one like "s" does:  a
+ * null-terminated string, or with "z", a size_t length followed by a pointer.
+ * Returns false for any other length modifier.
+ *
+ * Precision limits the input to that many bytes, and as with "%.Ns", the
+ * string needn't have a null within them.  The escaping and encoding
+ * conversions never shrink their input, so they need no more than that.
+ */
+static bool get_string_argument(struct conv *restrict conv,
+                                const char **str, size_t *str_len) {
+  const size_t max_len = conv->explicit_prec ? (size_t)conv->prec : SIZE_MAX;
+
+  switch (conv->length) {
+    case kLengthDefault: {
+      *str = va_arg(*conv->args, const char *);
+      if (conv->explicit_prec) {
+        const char *const end = memchr(*str, '\0', max_len);
+        *str_len = end ? (size_t)(end - *str) : max_len;
+      } else {
+        *str_len = strlen(*str);
+      }
+      return true;
+    }
+    case kLengthSizeT: {
+      *str_len = va_arg(*conv->args, size_t);
+      *str     = va_arg(*conv->args, const char *);
+      if (*str_len > max_len) { *str_len = max_len; }
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*******************************************************************************
+ * Utility Functions: Integer and string conversion implementation.
+ ******************************************************************************/
+
+/* Assume MSB is sign bit. */
+#define SIGN_BIT (ULLONG_MAX - ULLONG_MAX / 2)
+
+/* Digits for printing. */
+static const char hex_digits[2][17] = {
+  "0123456789abcdef", "0123456789ABCDEF"
+};
+
+/*
+ * The two hex digits for each byte value, so hex dumps can convert a byte
+ * at a time with one table lookup.
+ */
+#define HEX_PAIRS_ROW_(h) \
+  h"0", h"1", h"2", h"3", h"4", h"5", h"6", h"7", \
+  h"8", h"9", h"a", h"b", h"c", h"d", h"e", h"f"
+
+static const char hex_pairs[256][2] = {
+  HEX_PAIRS_ROW_("0"), HEX_PAIRS_ROW_("1"), HEX_PAIRS_ROW_("2"),
+  HEX_PAIRS_ROW_("3"), HEX_PAIRS_ROW_("4"), HEX_PAIRS_ROW_("5"),
+  HEX_PAIRS_ROW_("6"), HEX_PAIRS_ROW_("7"), HEX_PAIRS_ROW_("8"),
+  HEX_PAIRS_ROW_("9"), HEX_PAIRS_ROW_("a"), HEX_PAIRS_ROW_("b"),
+  HEX_PAIRS_ROW_("c"), HEX_PAIRS_ROW_("d"), HEX_PAIRS_ROW_("e"),
+  HEX_PAIRS_ROW_("f")
+};
+
+#undef HEX_PAIRS_ROW_
+
+/*
+ * Converts an integer in the specified base, stored at the _end_ of buf[].
+ * Returns the index of the first character.
+ */
+static int convert_integer_to_string(
+    uintmax_t value, struct conv *restrict conv, char *restrict buf) {
+  char sign_char = '\0';  /* Default, no sign character. */
+  int idx = INT_BUF_SIZE;
+
+  buf[--idx] = '\0';
+
+  /* Print nothing if value and precision are both 0, and not alt octal. */
+  if (!value && !conv->prec && !(conv->is_alt && conv->base == 8)) {
+    return INT_BUF_SIZE - 1;
+  }
+
+  /* Determine sign and take absolutve value, for signed conversions. */
+  if (conv->is_signed) {
+    if      (value & SIGN_BIT)          { sign_char = '-'; value = -value; }
+    else if (conv->sign == kSignAlways) { sign_char = '+';                 }
+    else if (conv->sign == kSignSpace)  { sign_char = ' ';                 }
+  }
+
+  /* Convert the digits, starting with the least significant. */
+  const char *const hd = hex_digits[conv->is_caps];
+  const unsigned base = conv->base;
+  do {
+    buf[--idx] = hd[value % base];
+    value /= base;
+  } while (value > 0);
+
+  /*
+   * If our precision actually came from the width field, adjust it based on
+   * other things we might print before the padding zeros.
+   */
+  if (conv->soft_prec) {
+    if (conv->is_alt && conv->base == 16)                   { conv->prec -= 2; }
+    if (conv->is_alt && conv->base == 8 && buf[idx] != '0') { conv->prec -= 1; }
+    if (sign_char)                                          { conv->prec -= 1; }
+
+    if (conv->prec < 1) { conv->prec = 1; }  /* Not too small! */
+  }
+
+  /*
+   * Compute index for padding zeros, out to precision.  Bound the number of
+   * leading zeros to what fits in our buffer.  print_diouxXp_conversions()
+   * prints any more with the printer's fill().
+   */
+  int prec_idx = conv->prec < INT_BUF_SIZE - 1 ? INT_BUF_SIZE - conv->prec : 1;
+
+  /* Leave room for "0x"/"0" if alt-form hex or octal, and room for sign. */
+  if (prec_idx < 3 && conv->is_alt && conv->base == 16) { prec_idx = 3; }
+  if (prec_idx < 2 && conv->is_alt && conv->base == 8)  { prec_idx = 2; }
+  if (prec_idx < 2 && sign_char)                        { prec_idx = 2; }
+
+  /* Add leading zeros out to precision index. */
+  while (idx >= prec_idx) { buf[--idx] = '0'; }
+
+  /* If we're alternate-form octal, add a leading 0 if needed. */
+  if (conv->is_alt && conv->base == 8 && buf[idx] != '0') { buf[--idx] = '0'; }
+
+  /* If we're alternate-form hex, add a leading "0x" or "0X". */
+  if (conv->is_alt && conv->base == 16) {
+    buf[--idx] = conv->is_caps ? 'X' : 'x';
+    buf[--idx] = '0';
+  }
+
+  /* Add the sign character, if any. */
+  if (sign_char) { buf[--idx] = sign_char; }
+
+  return idx;
+}
+
+/*
+ * Encodes a code point as UTF-8 in buf[], returning the number of bytes.
+ * Surrogates and values beyond U+10FFFF become U+FFFD, the replacement
+ * character, rather than producing ill-formed output.
+ */
+static int encode_utf8(uint_least32_t cp, char *restrict buf) {
+  if (cp < 0x80) { buf[0] = cp; return 1; }
+
+  if (cp < 0x800) {
+    buf[0] = 0xC0 | (cp >> 6);
+    buf[1] = 0x80 | (cp & 0x3F);
+    return 2;
+  }
+
+  if ((cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) { cp = 0xFFFD; }
+
+  if (cp < 0x10000) {
+    buf[0] = 0xE0 | (cp >> 12);
+    buf[1] = 0x80 | ((cp >> 6) & 0x3F);
+    buf[2] = 0x80 | (cp & 0x3F);
+    return 3;
+  }
+
+  buf[0] = 0xF0 | (cp >> 18);
+  buf[1] = 0x80 | ((cp >> 12) & 0x3F);
+  buf[2] = 0x80 | ((cp >> 6) & 0x3F);
+  buf[3] = 0x80 | (cp & 0x3F);
+  return 4;
+}
+
+/*
+ * Wide strings get encoded into a local buffer of WIDE_BUF_SIZE bytes, which
+ * we flush to the printer as it fills.  Runs of ASCII get handled WIDE_BLOCK
+ * code units at a time:  the fixed-size OR-reduction and narrowing loops are
+ * shaped so the compiler can turn each into a handful of vector instructions.
+ */
+#define WIDE_BUF_SIZE (256)
+#define WIDE_BLOCK    (16)
+
+/*
+ * Encodes ws as UTF-8, up to its null or its first ws_len code units, and
+ * stopping early rather than exceed max_len bytes.  Sends the output to p, or
+ * merely measures it if p is NULL.  Returns the number of bytes encoded.
+ *
+ * A ws_len of SIZE_MAX means the length is unknown.  Then we read one code
+ * unit at a time, and none past the null or the last one that fits, as the
+ * fast path's block reads could run off the end of an array with no null.
+ */
+static size_t encode_wide_string(const wchar_t *ws, size_t ws_len,
+                                 size_t max_len, struct printer *p) {
+  const bool known_len = ws_len != SIZE_MAX;
+  char buf[WIDE_BUF_SIZE];
+  size_t total = 0;  /* Bytes encoded prior to what's in buf[]. */
+  int idx = 0;
+
+  while (ws_len && total + idx < max_len && *ws) {
+    /* ASCII fast path:  whole blocks of code units below 0x80. */
+    while (known_len && ws_len >= WIDE_BLOCK &&
+           idx <= WIDE_BUF_SIZE - WIDE_BLOCK &&
+           max_len - total - idx >= WIDE_BLOCK) {
+      uint_least32_t bits = 0;
+      for (int i = 0; i < WIDE_BLOCK; i++) { bits |= (uint_least32_t)ws[i]; }
+      if (bits >= 0x80) { break; }
+
+      for (int i = 0; i < WIDE_BLOCK; i++) { buf[idx + i] = ws[i]; }
+      idx    += WIDE_BLOCK;
+      ws     += WIDE_BLOCK;
+      ws_len -= WIDE_BLOCK;
+    }
+
+    if (idx > WIDE_BUF_SIZE - 4) {  /* Make room for one more character. */
+      if (p) { p->copy(p, buf, buf + idx); }
+      total += idx;
+      idx = 0;
+    }
+
+    if (!ws_len || total + idx == max_len || !*ws) { break; }
+
+    /* Slow path:  one character, possibly a UTF-16 surrogate pair. */
+    uint_least32_t cp = (uint_least32_t)*ws;
+    int units = 1;
+#if WCHAR_MAX <= 0xFFFF
+    if (cp >= 0xD800 && cp <= 0xDBFF && ws_len > 1) {
+      /* A pair takes 4 bytes.  Without room, don't read its second half. */
+      if (max_len - total - idx < 4) { break; }
+      if ((uint_least32_t)ws[1] >= 0xDC00 && (uint_least32_t)ws[1] <= 0xDFFF) {
+        cp = 0x10000 + ((cp - 0xD800) << 10) + ((uint_least32_t)ws[1] - 0xDC00);
+        units = 2;
+      }
+    }
+#endif
+
+    char enc[4];
+    const int enc_len = encode_utf8(cp, enc);
+    if (max_len - total - idx < (size_t)enc_len) { break; }  /* Won't fit. */
+    ws     += units;
+    ws_len -= units;
+
+    memcpy(buf + idx, enc, enc_len);
+    idx += enc_len;
+  }
+
+  if (p && idx) { p->copy(p, buf, buf + idx); }
+  return total + idx;
+}
+
+/*
+ * UTF-8 character counting works a word at a time.  A character starts at
+ * every byte that isn't a continuation byte (0b10xxxxxx), so we count the
+ * continuation bytes in each word and subtract.  x & ~(x << 1) sets the top
+ * bit of each byte whose top two bits are 0b10; the multiply then sums those
+ * bits into the most significant byte.
+ */
+#define WORD_ONES  (UINT64_MAX / 0xFF)      /* 0x0101...01 */
+#define WORD_HIGHS (WORD_ONES * 0x80)       /* 0x8080...80 */
+
+/* Counts the continuation bytes in an 8-byte word. */
+static inline unsigned count_utf8_continuations(uint64_t word) {
+  const uint64_t cont = word & ~(word << 1) & WORD_HIGHS;
+  return ((cont >> 7) * WORD_ONES) >> 56;
+}
+
+/* Counts the UTF-8 characters in a string of len bytes. */
+static size_t count_utf8_chars(const char *str, size_t len) {
+  size_t chars = len;
+  size_t i = 0;
+
+  for (; len - i >= sizeof(uint64_t); i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, str + i, sizeof(word));
+    chars -= count_utf8_continuations(word);
+  }
+
+  for (; i < len; i++) { chars -= (str[i] & 0xC0) == 0x80; }
+
+  return chars;
+}
+
+/*
+ * Returns the length in bytes of the longest prefix of a len-byte string that
+ * holds at most count UTF-8 characters.  Never splits a character.
+ */
+static size_t skip_utf8_chars(const char *str, size_t len, size_t count) {
+  size_t i = 0;
+
+  /* Skip whole words while they can't contain the end of the prefix. */
+  for (; len - i >= sizeof(uint64_t); i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, str + i, sizeof(word));
+    const unsigned chars = sizeof(word) - count_utf8_continuations(word);
+    if (chars >= count) { break; }
+    count -= chars;
+  }
+
+  /* Stop at the start of the first character past the prefix. */
+  for (; i < len; i++) {
+    if ((str[i] & 0xC0) != 0x80 && count-- == 0) { break; }
+  }
+
+  return i;
+}
+
+/*
+ * Returns the length in bytes of a null-terminated string's first count UTF-8
+ * characters, or of the whole string if it's shorter.  Reads one character
+ * at a time, and takes only the continuation bytes the last character's lead
+ * byte calls for, so it never reads past the prefix.  This matters for "%'.Ns"
+ * of an array with no null.
+ */
+static size_t utf8_prefix_length(const char *str, size_t count) {
+  size_t i = 0;
+
+  while (count && str[i]) {
+    const unsigned char lead = str[i++];
+    if ((lead & 0xC0) == 0x80) { continue; }  /* Stray continuation byte. */
+    count--;
+
+    int more = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+    for (; more && (str[i] & 0xC0) == 0x80; more--) { i++; }
+  }
+
+  return i;
+}
+
+/*
+ * Escaping conversions look for the next byte needing an escape a word at a
+ * time, using the usual tricks to spot bytes that are zero or less than n:
+ *
+ *   any byte zero:    (x - ONES) & ~x & HIGHS
+ *   any byte < n:     (x - ONES * n) & ~x & HIGHS    (for n <= 0x80)
+ *
+ * Comparing with c is testing x ^ (ONES * c) for zero.  These never miss a
+ * byte, but may flag extra bytes following a true hit.  So, once a word has
+ * a hit, we step through it a byte at a time.
+ */
+#define WORD_HAS_LESS(x, n) (((x) - WORD_ONES * (n)) & ~(x) & WORD_HIGHS)
+#define WORD_HAS_BYTE(x, c) WORD_HAS_LESS((x) ^ (WORD_ONES * (c)), 1)
+
+/* Returns true if a byte needs escaping in the given style. */
+static inline bool needs_escape(const struct escape_style *style,
+                                unsigned char c) {
+  return c < style->below || (style->high && c >= 0x7F) ||
+         c == (unsigned char)style->special[0] ||
+         c == (unsigned char)style->special[1] ||
+         c == (unsigned char)style->special[2] ||
+         c == (unsigned char)style->special[3];
+}
+
+/* Finds the first byte in [s, e) that needs escaping, or returns e. */
+static const char *find_escape(const struct escape_style *style,
+                               const char *s, const char *e) {
+  const uint64_t s0 = (unsigned char)style->special[0];
+  const uint64_t s1 = (unsigned char)style->special[1];
+  const uint64_t s2 = (unsigned char)style->special[2];
+  const uint64_t s3 = (unsigned char)style->special[3];
+
+  for (; e - s >= (ptrdiff_t)sizeof(uint64_t); s += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, s, sizeof(word));
+
+    uint64_t hits = WORD_HAS_LESS(word, style->below) |
+                    WORD_HAS_BYTE(word, s0) |
+                    WORD_HAS_BYTE(word, s1) |
+                    WORD_HAS_BYTE(word, s2) |
+                    WORD_HAS_BYTE(word, s3);
+    if (style->high) {
+      hits |= (word & WORD_HIGHS) | WORD_HAS_BYTE(word, 0x7F);
+    }
+    if (hits) { break; }
+  }
+
+  while (s != e && !needs_escape(style, *s)) { s++; }
+  return s;
+}
+
+/* Size of the largest escape sequence any style produces. */
+#define ESCAPE_BUF_SIZE (8)
+
+/*
+ * Escapes [s, e) in the given style, stopping early rather than exceed max_len
+ * bytes of output or split an escape sequence.  Runs of bytes that need no
+ * escape go out in a single copy.  Sends the output to p, or merely measures
+ * it if p is NULL.  Returns the number of bytes output.
+ */
+static size_t escape_string(const struct escape_style *style,
+                            const char *s, const char *e,
+                            size_t max_len, struct printer *p) {
+  size_t total = 0;
+
+  while (s != e) {
+    const char *const run_end = find_escape(style, s, e);
+    size_t run_len = run_end - s;
+    if (run_len > max_len - total) { run_len = max_len - total; }
+
+    if (p && run_len) { p->copy(p, s, s + run_len); }
+    total += run_len;
+    s     += run_len;
+
+    if (s != run_end || s == e) { break; }  /* Out of room, or done. */
+
+    char buf[ESCAPE_BUF_SIZE];
+    const size_t esc_len = style->escape(*s++, buf);
+    if (esc_len > max_len - total) { break; }
+
+    if (p) { p->copy(p, buf, buf + esc_len); }
+    total += esc_len;
+  }
+
+  return total;
+}
+
+/*
+ * Prints a string escaped in the given style, optionally wrapped in quotes.
+ * Precision limits the escaped text, not counting the quotes, and the width
+ * applies to the escaped text with its quotes and the style's prefix.
+ */
+static bool print_escaped_string(struct conv *restrict conv,
+                                 const struct escape_style *style, char quote,
+                                 const char *str, size_t str_len) {
+  const char *const end       = str + str_len;
+  const size_t      max_len   = conv->explicit_prec ? conv->prec : SIZE_MAX;
+  const size_t      quote_len = !quote ? 0 : style->prefix ? 3 : 2;
+  struct printer *restrict p  = conv->printer;
+
+  size_t out_len = 0;
+  if (!conv->left_justify && conv->width) {
+    out_len = escape_string(style, str, end, max_len, NULL) + quote_len;
+    const size_t fill_count = pad_width(conv, out_len);
+    if (fill_count) { p->fill(p, ' ', fill_count); }
+  }
+
+  if (quote && style->prefix) { p->putc(p, style->prefix); }
+  if (quote) { p->putc(p, quote); }
+  out_len = escape_string(style, str, end, max_len, p) + quote_len;
+  if (quote) { p->putc(p, quote); }
+
+  const size_t fill_count = pad_width(conv, out_len);
+  if (conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  return true;
+}
+
+/* Writes a JSON escape sequence for a character. */
+static int escape_json(unsigned char c, char *buf) {
+  buf[0] = '\\';
+  switch (c) {
+    case '"':  { buf[1] = '"';  return 2; }
+    case '\\': { buf[1] = '\\'; return 2; }
+    case '\b': { buf[1] = 'b';  return 2; }
+    case '\f': { buf[1] = 'f';  return 2; }
+    case '\n': { buf[1] = 'n';  return 2; }
+    case '\r': { buf[1] = 'r';  return 2; }
+    case '\t': { buf[1] = 't';  return 2; }
+  }
+
+  memcpy(buf + 1, "u00", 3);
+  buf[4] = hex_digits[0][c >> 4];
+  buf[5] = hex_digits[0][c & 0xF];
+  return 6;
+}
+
+/* JSON escapes quotes, backslashes and control characters. */
+static const struct escape_style json_style = {
+  .below = 0x20, .special = { '"', '\\', '\\', '\\' },
+  .escape = escape_json
+};
+
+/*
+ * Writes a C escape sequence for a character.  Others take three octal
+ * digits, which always end the escape, unlike "\xNN" before a hex digit.
+ */
+static int escape_c(unsigned char c, char *buf) {
+  buf[0] = '\\';
+  switch (c) {
+    case '"':  { buf[1] = '"';  return 2; }
+    case '\\': { buf[1] = '\\'; return 2; }
+    case '\a': { buf[1] = 'a';  return 2; }
+    case '\b': { buf[1] = 'b';  return 2; }
+    case '\f': { buf[1] = 'f';  return 2; }
+    case '\n': { buf[1] = 'n';  return 2; }
+    case '\r': { buf[1] = 'r';  return 2; }
+    case '\t': { buf[1] = 't';  return 2; }
+    case '\v': { buf[1] = 'v';  return 2; }
+  }
+
+  buf[1] = '0' + (c >> 6);
+  buf[2] = '0' + (c >> 3 & 7);
+  buf[3] = '0' + (c & 7);
+  return 4;
+}
+
+/*
+ * C literals escape quotes, backslashes, and anything that isn't printable
+ * ASCII, so that no string can forge a line break or terminal control.
+ */
+static const struct escape_style c_style = {
+  .below = 0x20, .high = true, .special = { '"', '\\', '\\', '\\' },
+  .escape = escape_c
+};
+
+/* Writes a $'...' escape sequence for a character:  C's, plus \' for '. */
+static int escape_shell(unsigned char c, char *buf) {
+  if (c != '\'') { return escape_c(c, buf); }
+  buf[0] = '\\';
+  buf[1] = '\'';
+  return 2;
+}
+
+/*
+ * Shells take everything inside plain single quotes literally, newlines and
+ * terminal controls included, so we use $'...' instead, as POSIX.1-2024, bash,
+ * ksh and zsh do.  It takes C's backslash escapes, so nothing unprintable
+ * gets through as-is.
+ */
+static const struct escape_style shell_style = {
+  .below = 0x20, .high = true, .special = { '\'', '\\', '\\', '\\' },
+  .prefix = '$', .escape = escape_shell
+};
+
+/* Writes a doubled quote, the only escape within a quoted CSV field. */
+static int escape_csv(unsigned char c, char *buf) {
+  buf[0] = buf[1] = c;
+  return 2;
+}
+
+/*
+ * A CSV field needs quotes if it holds a quote, comma or line break.  Quoted
+ * fields double their quotes and leave everything else alone.  The unquoted
+ * style never escapes anything, as we only use it when find_escape() finds
+ * nothing.
+ */
+static const struct escape_style csv_style = {
+  .special = { '"', ',', '\n', '\r' }, .escape = escape_csv
+};
+
+static const struct escape_style csv_quoted_style = {
+  .special = { '"', '"', '"', '"' }, .escape = escape_csv
+};
+
+/* Writes a TSV escape sequence for a character. */
+static int escape_tsv(unsigned char c, char *buf) {
+  buf[0] = '\\';
+  switch (c) {
+    case '\t': { buf[1] = 't';  break; }
+    case '\n': { buf[1] = 'n';  break; }
+    case '\r': { buf[1] = 'r';  break; }
+    default:   { buf[1] = '\\'; break; }
+  }
+  return 2;
+}
+
+/* TSV fields can't hold tabs or line breaks, so escape those, and \. */
+static const struct escape_style tsv_style = {
+  .special = { '\t', '\n', '\r', '\\' }, .escape = escape_tsv
+};
+
+/* Classifies bytes for percent-encoding.  0x80 and up are all kUrlOther. */
+static const unsigned char url_class[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0x00 - 0x0F */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0x10 - 0x1F */
+  0, 1, 0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 2, 2, 1,  /* 0x20 - 0x2F */
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 0, 1, 0, 1,  /* 0x30 - 0x3F */
+  1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  /* 0x40 - 0x4F */
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 0, 1, 0, 2,  /* 0x50 - 0x5F */
+  0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  /* 0x60 - 0x6F */
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 2, 0,  /* 0x70 - 0x7F */
+};
+
+/* Size of the buffer for runs of percent-encoded bytes.  A multiple of 3. */
+#define URL_BUF_SIZE (96)
+
+/*
+ * Percent-encodes [s, e), leaving alone bytes whose class is at least keep.
+ * Runs of bytes we leave alone go out in a single copy, as do runs of up to
+ * URL_BUF_SIZE / 3 encoded bytes.  Sends the output to p, or merely measures
+ * it if p is NULL.  Returns the number of bytes output.
+ */
+static size_t encode_url(const char *s, const char *e, unsigned char keep,
+                         struct printer *p) {
+  size_t total = 0;
+
+  while (s != e) {
+    const char *const run = s;
+    while (s != e && url_class[(unsigned char)*s] >= keep) { s++; }
+
+    if (p && s != run) { p->copy(p, run, s); }
+    total += s - run;
+
+    char buf[URL_BUF_SIZE];
+    int idx = 0;
+    while (s != e && url_class[(unsigned char)*s] < keep &&
+           idx < URL_BUF_SIZE) {
+      const unsigned char c = *s++;
+      buf[idx++] = '%';
+      buf[idx++] = hex_digits[1][c >> 4];
+      buf[idx++] = hex_digits[1][c & 0xF];
+    }
+
+    if (p && idx) { p->copy(p, buf, buf + idx); }
+    total += idx;
+  }
+
+  return total;
+}
+
+/* Size of the buffer for hex digits, flushed as it fills. */
+#define HEX_BUF_SIZE (96)
+
+/*
+ * Prints bytes in hex, with a space between each group of bytes of the given
+ * size, or with no spaces if the group size is 0.
+ */
+static void print_hex_bytes(struct printer *p, const unsigned char *data,
+                            size_t len, size_t group) {
+  char buf[HEX_BUF_SIZE];
+  int idx = 0;
+
+  for (size_t i = 0; i < len; i++) {
+    if (idx > HEX_BUF_SIZE - 3) { p->copy(p, buf, buf + idx); idx = 0; }
+    if (group && i && i % group == 0) { buf[idx++] = ' '; }
+    memcpy(buf + idx, hex_pairs[data[i]], 2);
+    idx += 2;
+  }
+
+  if (idx) { p->copy(p, buf, buf + idx); }
+}
+
+/* Bytes per line in a multi-line hex dump. */
+#define HEX_DUMP_LINE (16)
+
+/*
+ * Prints a multi-line hex dump in the style of xxd:  an offset, the bytes in
+ * hex in groups of the given size, and the bytes as ASCII, with a '.' for
+ * anything unprintable.  Builds each line in a buffer, for one copy per line.
+ */
+static void print_hex_dump(struct printer *p, const unsigned char *data,
+                           size_t len, size_t group) {
+  /* Use at least 8 digits for offsets, and more if the dump needs them. */
+  int offset_digits = 8;
+  while (offset_digits < 16 && ((len - 1) >> (4 * offset_digits))) {
+    offset_digits++;
+  }
+
+  for (size_t offset = 0; offset < len; offset += HEX_DUMP_LINE) {
+    const size_t line_len = len - offset < HEX_DUMP_LINE ? len - offset
+                                                         : HEX_DUMP_LINE;
+    char buf[HEX_BUF_SIZE];
+    int idx = 0;
+
+    for (int i = offset_digits - 1; i >= 0; i--) {
+      buf[idx++] = hex_digits[0][(offset >> (4 * i)) & 0xF];
+    }
+    buf[idx++] = ':';
+
+    /* Hex digits, padding out short lines so the ASCII lines up. */
+    for (size_t i = 0; i < HEX_DUMP_LINE; i++) {
+      if (i % group == 0) { buf[idx++] = ' '; }
+      if (i < line_len) {
+        memcpy(buf + idx, hex_pairs[data[offset + i]], 2);
+      } else {
+        memset(buf + idx, ' ', 2);
+      }
+      idx += 2;
+    }
+
+    buf[idx++] = ' ';
+    buf[idx++] = ' ';
+
+    for (size_t i = 0; i < line_len; i++) {
+      const unsigned char c = data[offset + i];
+      buf[idx++] = c >= 0x20 && c < 0x7F ? c : '.';
+    }
+    buf[idx++] = '\n';
+
+    p->copy(p, buf, buf + idx);
+  }
+}
+
+/* Size of the buffer for base64 and base32 digits, flushed as it fills. */
+#define BASE_N_BUF_SIZE (128)
+
+/*
+ * Prints a buffer of bytes in base64 or base32, with 6 or 5 bits per digit.
+ * The encoding comes in groups of 4 or 8 digits, with the last group padded
+ * out with '=' unless the "+" flag says not to.  Precision limits the number
+ * of characters we print, and width applies to the encoded output.
+ */
+static bool print_base_n(struct conv *restrict conv, const char *digits,
+                         int bits) {
+  const unsigned char *const data = va_arg(*conv->args, const void *);
+  const size_t               len  = va_arg(*conv->args, size_t);
+  struct printer *restrict   p    = conv->printer;
+
+  const size_t group_len = bits == 6 ? 4 : 8;
+  const size_t digit_len = (len / bits) * 8 +         /* ceil(len * 8 / bits) */
+                           ((len % bits) * 8 + bits - 1) / bits;
+  size_t out_len = digit_len;
+  if (conv->sign == kSignDefault) {
+    out_len = (digit_len + group_len - 1) / group_len * group_len;
+  }
+  if (conv->explicit_prec && out_len > (size_t)conv->prec) {
+    out_len = conv->prec;
+  }
+
+  const size_t fill_count = pad_width(conv, out_len);
+  if (!conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  /* Shift bytes into an accumulator, and digits out of it. */
+  const unsigned mask = (1u << bits) - 1;
+  uint_fast32_t acc = 0;
+  int acc_bits = 0;
+  char buf[BASE_N_BUF_SIZE];
+  int idx = 0;
+  size_t done = 0;
+
+  for (size_t i = 0; done < out_len; ) {
+    if (idx == BASE_N_BUF_SIZE) { p->copy(p, buf, buf + idx); idx = 0; }
+
+    if (acc_bits >= bits) {            /* Have a whole digit. */
+      acc_bits -= bits;
+      buf[idx++] = digits[(acc >> acc_bits) & mask];
+    } else if (i < len) {              /* Need another byte. */
+      acc = acc << 8 | data[i++];
+      acc_bits += 8;
+      continue;
+    } else if (acc_bits > 0) {         /* Last, partial digit. */
+      buf[idx++] = digits[(acc << (bits - acc_bits)) & mask];
+      acc_bits = 0;
+    } else {                           /* Padding. */
+      buf[idx++] = '=';
+    }
+    done++;
+  }
+
+  if (idx) { p->copy(p, buf, buf + idx); }
+  if (conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  return true;
+}
+
+/*
+ * Formats the UTC date and time for a count of seconds since the epoch, as
+ * YYYY-MM-DDThh:mm:ss.  Keeps the result in a per-thread cache, and only
+ * reformats it when the second changes.  Returns a null-terminated string
+ * that's good until the thread's next call.
+ */
+static const char *format_date_time(intmax_t sec) {
+  static _Thread_local struct {
+    bool     valid;
+    intmax_t sec;
+    char     text[40];
+  } cache;
+
+  if (cache.valid && cache.sec == sec) { return cache.text; }
+
+  /* Split into days and seconds within the day, rounding toward -infinity. */
+  intmax_t days = sec / 86400, secs = sec % 86400;
+  if (secs < 0) { secs += 86400; days--; }
+
+  /*
+   * Convert days since 1970-01-01 to a civil date, using Howard Hinnant's
+   * days_from_civil inverse.  Eras are 400-year cycles starting in March.
+   */
+  const intmax_t z   = days + 719468;
+  const intmax_t era = (z >= 0 ? z : z - 146096) / 146097;
+  const intmax_t doe = z - era * 146097;                     /* [0, 146096] */
+  const intmax_t yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+  const intmax_t doy = doe - (365*yoe + yoe/4 - yoe/100);    /* [0, 365]    */
+  const intmax_t mp  = (5*doy + 2) / 153;                    /* [0, 11]     */
+  const int      day = doy - (153*mp + 2) / 5 + 1;           /* [1, 31]     */
+  const int      mon = mp < 10 ? mp + 3 : mp - 9;            /* [1, 12]     */
+  const intmax_t yr  = yoe + era * 400 + (mon <= 2);
+
+  /* Years outside 0000 to 9999 get however many digits they need. */
+  char int_buf[INT_BUF_SIZE];
+  struct conv year = { .base = 10, .prec = 4, .is_signed = true };
+  const int idx = convert_integer_to_string(yr, &year, int_buf);
+  const size_t year_len = INT_BUF_SIZE - idx - 1;
+
+  char *t = cache.text;
+  memcpy(t, int_buf + idx, year_len);
+  t += year_len;
+
+  const int fields[5] = { mon, day, secs / 3600, secs / 60 % 60, secs % 60 };
+  const char seps[5]  = { '-', '-', 'T', ':', ':' };
+  for (int i = 0; i < 5; i++) {
+    *t++ = seps[i];
+    *t++ = '0' + fields[i] / 10;
+    *t++ = '0' + fields[i] % 10;
+  }
+  *t = '\0';
+
+  cache.valid = true;
+  cache.sec   = sec;
+  return cache.text;
+}
+
+/* Formats an IPv4 address in dotted-decimal.  Returns the length. */
+static int format_ipv4(const unsigned char *addr, char *restrict buf) {
+  int idx = 0;
+
+  for (int i = 0; i < 4; i++) {
+    const unsigned b = addr[i];
+    if (i)        { buf[idx++] = '.'; }
+    if (b >= 100) { buf[idx++] = '0' + b / 100; }
+    if (b >= 10)  { buf[idx++] = '0' + b / 10 % 10; }
+    buf[idx++] = '0' + b % 10;
+  }
+
+  return idx;
+}
+
+/*
+ * Formats an IPv6 address in the canonical form from RFC 5952:  lowercase
+ * hex without leading zeros, with the longest run of two or more zero fields
+ * (the first, if tied) compressed to "::".  IPv4-mapped addresses end in
+ * dotted-decimal, as in ::ffff:192.0.2.1.  Returns the length.
+ */
+static int format_ipv6(const unsigned char *addr, char *restrict buf) {
+  unsigned fields[8];
+  for (int i = 0; i < 8; i++) { fields[i] = addr[2*i] << 8 | addr[2*i + 1]; }
+
+  /* Find the longest run of zero fields. */
+  int best_start = -1, best_len = 1;
+  for (int i = 0; i < 8; ) {
+    int j = i;
+    while (j < 8 && !fields[j]) { j++; }
+    if (j - i > best_len) { best_start = i; best_len = j - i; }
+    i = j > i ? j : i + 1;
+  }
+
+  const bool mapped = best_start == 0 && best_len == 5 && fields[5] == 0xFFFF;
+  const int  num_hex = mapped ? 6 : 8;
+  int idx = 0;
+
+  for (int i = 0; i < num_hex; i++) {
+    if (i == best_start) {
+      buf[idx++] = ':';
+      buf[idx++] = ':';
+      i += best_len - 1;
+      continue;
+    }
+
+    if (i && i != best_start + best_len) { buf[idx++] = ':'; }
+
+    /* Hex digits, skipping leading zeros. */
+    int shift = 12;
+    while (shift && !(fields[i] >> shift)) { shift -= 4; }
+    for (; shift >= 0; shift -= 4) {
+      buf[idx++] = hex_digits[0][(fields[i] >> shift) & 0xF];
+    }
+  }
+
+  if (mapped) {
+    buf[idx++] = ':';
+    idx += format_ipv4(addr + 12, buf + idx);
+  }
+
+  return idx;
+}
+
+/*
+ * Formats bytes in hex, in fields of the given numbers of bytes, separated
+ * by sep.  Returns the length.
+ */
+static int format_hex_fields(const unsigned char *bytes, const int *lengths,
+                             int num_fields, char sep, char *restrict buf) {
+  int idx = 0;
+
+  for (int f = 0; f < num_fields; f++) {
+    if (f) { buf[idx++] = sep; }
+    for (int i = 0; i < lengths[f]; i++) {
+      memcpy(buf + idx, hex_pairs[*bytes++], 2);
+      idx += 2;
+    }
+  }
+
+  return idx;
+}
+
+/*
+ * Returns how much fill pads a conversion of len characters out to its width.
+ * The width is an int, and len a size_t, so compare them as size_t values,
+ * which is safe because the width is never negative.
+ */
+static size_t pad_width(const struct conv *restrict conv, size_t len) {
+  const size_t width = (size_t)conv->width;
+  return width > len ? width - len : 0;
+}
+
+/*
+ * Prints a converted string in a particular width field.  With the "'" flag,
+ * the width counts UTF-8 characters rather than bytes.
+ */
+static bool print_converted_string(struct conv *restrict conv,
+                                   const char *restrict str, size_t str_len) {
+  const size_t str_width  = conv->count_chars ? count_utf8_chars(str, str_len)
+                                              : str_len;
+  const size_t fill_count = pad_width(conv, str_width);
+  struct printer *restrict p = conv->printer;
+
+  if (!conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+  p->copy(p, str, str + str_len);
+  if ( conv->left_justify && fill_count) { p->fill(p, ' ', fill_count); }
+
+  return true;
+}
+
+
+/*******************************************************************************
+ * Printers for writing to a FILE *:
+ *
+ *  -- printer_file_copy(struct printer *p, const char *s, const char *e)
+ *  -- printer_file_copy_str(struct printer *p, const char *s, size_t max)
+ *  -- printer_file_fill(struct printer *p, const char *s, size_t len)
+ *  -- printer_file_putc(struct printer *p, const char c)
+ *  -- printer_file_done(struct printer *p):  No-op.
+ *
+ ******************************************************************************/
+
+/* Copies a string to a file. */
+static void printer_file_copy(struct printer *p, const char *s, const char *e) {
+  size_t len = e - s;
+  p->total += len;
+  fwrite(s, 1, len, p->file);
+}
+
+/* Copies a string to a file.  A FILE has no contiguous space to copy into. */
+static size_t printer_file_copy_str(struct printer *p, const char *s,
+                                    size_t max) {
+  const char *const e = memchr(s, '\0', max);
+  const size_t len = e ? (size_t)(e - s) : max;
+  printer_file_copy(p, s, s + len);
+  return len;
+}
+
+/*
+ * Page-sized spans of the usual padding characters, so that wide fields pad
+ * with a few large writes rather than many small ones.  They're const, so
+ * they live in read-only data, shared by every thread.
+ */
+#define FILL_SPAN_SIZE 4096
+
+#define FILL_4_(c)    c, c, c, c
+#define FILL_16_(c)   FILL_4_(c),   FILL_4_(c),   FILL_4_(c),   FILL_4_(c)
+#define FILL_64_(c)   FILL_16_(c),  FILL_16_(c),  FILL_16_(c),  FILL_16_(c)
+#define FILL_256_(c)  FILL_64_(c),  FILL_64_(c),  FILL_64_(c),  FILL_64_(c)
+#define FILL_1024_(c) FILL_256_(c), FILL_256_(c), FILL_256_(c), FILL_256_(c)
+#define FILL_4096_(c) FILL_1024_(c),FILL_1024_(c),FILL_1024_(c),FILL_1024_(c)
+
+static _Alignas(FILL_SPAN_SIZE) const char fill_spaces[FILL_SPAN_SIZE] = {
+  FILL_4096_(' ')
+};
+static _Alignas(FILL_SPAN_SIZE) const char fill_zeros[FILL_SPAN_SIZE] = {
+  FILL_4096_('0')
+};
+
+#undef FILL_4_
+#undef FILL_16_
+#undef FILL_64_
+#undef FILL_256_
+#undef FILL_1024_
+#undef FILL_4096_
+
+/*
+ * Writes a block of fill characters to a file.  Spaces and zeros come from
+ * the shared spans, a page per fwrite().  Anything else gets a local span.
+ */
+static void printer_file_fill(struct printer *p, char c, size_t len) {
+  char buf[256];
+  const char *span = c == ' ' ? fill_spaces : c == '0' ? fill_zeros : buf;
+  size_t span_len = span == buf ? sizeof(buf) : FILL_SPAN_SIZE;
+
+  if (span == buf) { memset(buf, c, len < span_len ? len : span_len); }
+
+  p->total += len;
+
+  while (len >= span_len) {
+    fwrite(span, 1, span_len, p->file);
+    len -= span_len;
+  }
+
+  if (len > 0) {
+    fwrite(span, 1, len, p->file);
+  }
+}
+
+/* Copies a character to a file. */
+static void printer_file_putc(struct printer *p, char c) {
+  p->total++;
+  fputc(c, p->file);
+}
+
+/* Does nothing. */
+static void printer_file_done(struct printer *p) { (void)p; }
+
+/*******************************************************************************
+ * Printers for writing to a buffer in memory:
+ *
+ *  -- printer_buf_copy(struct printer *p, const char *s, const char *e)
+ *  -- printer_buf_copy_str(struct printer *p, const char *s, size_t max)
+ *  -- printer_buf_fill(struct printer *p, const char *s, size_t len)
+ *  -- printer_buf_putc(struct printer *p, const char c)
+ *  -- printer_buf_done(struct printer *p):  null-terminate.
+ *
+ ******************************************************************************/
+
+/* Copies a string to a buffer. */
+static void printer_buf_copy(struct printer *p, const char *s, const char *e) {
+  size_t len = e - s;
+
+  if (p->total >= p->max) {
+    p->total += len;
+    return;
+  }
+
+  size_t avail = p->max - p->total;
+  char *target = p->buf + p->total;
+  p->total += len;
+
+  if (len > avail) { len = avail; }  /* Limit our output to what's allowed. */
+  memcpy(target, s, len);
+}
+
+/*
+ * Copies a string to a buffer, finding its length as we go.  memccpy() does
+ * the copy and the search for the null in a single pass.  We only need a
+ * separate scan for whatever didn't fit in the buffer.
+ */
+static size_t printer_buf_copy_str(struct printer *p, const char *s,
+                                   size_t max) {
+  size_t avail = p->total < p->max ? p->max - p->total : 0;
+  size_t len   = 0;
+
+  if (avail) {
+    char *const target = p->buf + p->total;
+    const char *const end = memccpy(target, s, '\0', avail < max ? avail : max);
+
+    if (end) {  /* Found (and copied) the null:  we're done. */
+      len = end - target - 1;
+      p->total += len;
+      return len;
+    }
+
+    len = avail < max ? avail : max;
+  }
+
+  /* Account for the rest of the string, which didn't fit. */
+  const char *const e = memchr(s + len, '\0', max - len);
+  len = e ? (size_t)(e - s) : max;
+  p->total += len;
+  return len;
+}
+
+/* Writes a block of fill characters to a buffer. */
+static void printer_buf_fill(struct printer *p, char c, size_t len) {
+  if (p->total >= p->max) {
+    p->total += len;
+    return;
+  }
+
+  size_t avail = p->max - p->total;
+  char *target = p->buf + p->total;
+  p->total += len;
+
+  if (len > avail) { len = avail; }  /* Limit our output to what's allowed. */
+  memset(target, c, len);
+}
+
+/* Copies a character to a buffer. */
+static void printer_buf_putc(struct printer *p, char c) {
+  if (p->total >= p->max) {
+    p->total++;
+    return;
+  }
+
+  p->buf[p->total++] = c;
+}
+
+/* Null-terminates the output buffer. */
+static void printer_buf_done(struct printer *p) {
+  size_t end = p->total < p->max ? p->total : p->max;
+  p->buf[end] = '\0';
+}
+  
+
+/*******************************************************************************
+ * Identity cache maintenance:
+ *
+ *  -- simple_printf_set_thread_name(const char *name)
+ *
+ ******************************************************************************/
+
+/*
+ * Sets the calling thread's name, and updates the name that "#P" prints.
+ * Returns 0 on success, or an error number as pthread_setname_np() does.
+ */
+int simple_printf_set_thread_name(const char *name) {
+  const int err = pthread_setname_np(pthread_self(), name);
+  thread_name_text.len = 0;  /* Look the name up again next time. */
+  return err;
+}
+
+
+/*******************************************************************************
+ * Custom conversion registration:
+ *
+ *  -- simple_printf_register_conversion(char type, simple_conversion_fn *fn)
+ *  -- simple_printf_register_named(const char *name, simple_conversion_fn *fn)
+ *  -- simple_printf_freeze_conversions(void)
+ *
+ * Each returns 0 on success, or an error number:
+ *  -- EINVAL if the letter or name can't be used, or fn is NULL.
+ *  -- EEXIST if it's already in use.
+ *  -- ENOSPC if there's no room for another named conversion.
+ *  -- EBUSY if registration is frozen.
+ ******************************************************************************/
+
+/*
+ * Characters that can't be custom conversion letters:  flags, digits, length
+ * modifiers, and other characters with meaning inside a conversion spec.
+ */
+static const char reserved_conversion_chars[] = "-+ #0'123456789*.hljzt%{}";
+
+/* Binds a custom conversion to a letter that has no built-in conversion. */
+int simple_printf_register_conversion(char type, simple_conversion_fn *fn) {
+  const unsigned char idx = type;
+  if (!fn || !type || strchr(reserved_conversion_chars, type) ||
+      builtin_conversions[idx]) {
+    return EINVAL;
+  }
+
+  int err = 0;
+  pthread_mutex_lock(&conversions_lock);
+
+  if (atomic_load(&conversions_frozen)) {
+    err = EBUSY;
+  } else if (atomic_load_explicit(&custom_conversions[idx],
+                                  memory_order_relaxed)) {
+    err = EEXIST;
+  } else {
+    atomic_store_explicit(&custom_conversions[idx], fn, memory_order_release);
+  }
+
+  pthread_mutex_unlock(&conversions_lock);
+  return err;
+}
+
+/*
+ * Binds a custom conversion to a name, used as "%{name}".  Names can't be
+ * empty or contain '}', and must be shorter than NAMED_CONVERSION_LEN.
+ */
+int simple_printf_register_named(const char *name, simple_conversion_fn *fn) {
+  const size_t len = name ? strlen(name) : 0;
+  if (!fn || !len || len >= NAMED_CONVERSION_LEN || strchr(name, '}')) {
+    return EINVAL;
+  }
+
+  int err = ENOSPC;
+  pthread_mutex_lock(&conversions_lock);
+
+  if (atomic_load(&conversions_frozen)) {
+    err = EBUSY;
+  } else if (named_conversion_count < NAMED_CONVERSION_MAX * 3 / 4) {
+    for (size_t i = hash_conversion_name(name, len);;
+         i = (i + 1) % NAMED_CONVERSION_MAX) {
+      struct named_conversion *nc = &named_conversions[i];
+      if (!atomic_load_explicit(&nc->fn, memory_order_relaxed)) {
+        /* Fill in the name before publishing the slot. */
+        memcpy(nc->name, name, len + 1);
+        atomic_store_explicit(&nc->fn, fn, memory_order_release);
+        named_conversion_count++;
+        err = 0;
+        break;
+      }
+      if (!strcmp(nc->name, name)) { err = EEXIST; break; }
+    }
+  }
+
+  pthread_mutex_unlock(&conversions_lock);
+  return err;
+}
+
+/*
+ * Ends registration, so the conversion tables never change again.  It's
+ * optional:  lookups never lock either way.  Freezing just guarantees no
+ * conversion appears partway through a run, such as between threads.
+ */
+int simple_printf_freeze_conversions(void) {
+  atomic_store(&conversions_frozen, true);
+  return 0;
+}
+
+
+/*******************************************************************************
+ * Wrappers around printf_core for printing to a FILE* or stdout, either with
+ * a va_list or a variadic argument list:
+ *
+ *  -- simple_vfprintf(FILE *file, const char *fmt, va_list args)
+ *  -- simple_fprintf (FILE *file, const char *fmt, ...)
+ *  -- simple_vprintf (const char *fmt, va_list args)
+ *  -- simple_printf  (const char *fmt, ...)
+ *
+ ******************************************************************************/
+
+/* Prints to a FILE*, accepting arguments from va_list. */
+int simple_vfprintf(FILE *file, const char *fmt, va_list args) {
+  struct printer printer = {
+    .file = file,
+    .total = 0,
+    .copy = printer_file_copy,
+    .copy_str = printer_file_copy_str,
+    .fill = printer_file_fill,
+    .putc = printer_file_putc,
+    .done = printer_file_done
+  };
+
+  return printf_core(&printer, fmt, args);
+}
+
+/* Prints to stdout, accepting arguments from va_list. */
+int simple_vprintf(const char *fmt, va_list args) {
+  return simple_vfprintf(stdout, fmt, args);
+}
+
+/* Prints to a FILE*, accepting a variadic argument list. */
+int simple_fprintf(FILE *file, const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int ret = simple_vfprintf(file, fmt, args);
+  va_end(args);
+
+  return ret;
+}
+
+/* Prints to stdout, accepting a variadic argument list. */
+int simple_printf(const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int ret = simple_vfprintf(stdout, fmt, args);
+  va_end(args);
+
+  return ret;
+}
+
+/*******************************************************************************
+ * Wrappers around printf_core for printing to a buffer of known or unknown 
+ * size, either with a va_list or a variadic argument list:
+ *
+ *  -- simple_vsnprintf(char *buf, size_t max, const char *fmt, va_list args)
+ *  -- simple_snprintf (char *buf, size_t max, const char *fmt, ...)
+ *  -- simple_vsprintf (char *buf, const char *fmt, va_list args)
+ *  -- simple_sprintf  (char *buf, const char *fmt, ...)
+ *
+ ******************************************************************************/
+
+/* Prints up to max chars in a buffer, accepting arguments from va_list. */
+int simple_vsnprintf(char *buf, size_t max, const char *fmt, va_list args) {
+  struct printer printer = {
+    .buf = buf,
+    .max = max > 0 ? max - 1 : 0,  /* Save room for null! */
+    .total = 0,
+    .copy = printer_buf_copy,
+    .copy_str = printer_buf_copy_str,
+    .fill = printer_buf_fill,
+    .putc = printer_buf_putc,
+    .done = printer_buf_done
+  };
+
+  return printf_core(&printer, fmt, args);
+}
+
+/* Prints up to max chars in a buffer, accepting a variadic argument list. */
+int simple_snprintf(char *buf, size_t max, const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int ret = simple_vsnprintf(buf, max, fmt, args);
+  va_end(args);
+
+  return ret;  /* Total converted characters, possibly more than max. */
+}
+
+/* Prints unbounded chars in a buffer, accepting arguments from va_list. */
+int simple_vsprintf(char *buf, const char *fmt, va_list args) {
+  return simple_vsnprintf(buf, SIZE_MAX, fmt, args);  /* UNSAFE! */
+}
+
+/* Prints unbounded chars in a buffer, accepting a variadic argument list. */
+int simple_sprintf(char *buf, size_t max, const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int ret = simple_vsnprintf(buf, SIZE_MAX, fmt, args);  /* UNSAFE! */
+  va_end(args);
+
+  return ret;  /* Total converted characters, possibly more than max. */
+}
+
+
+/* A struct simple_reader that counts out digits, for testing "R". */
+struct digit_reader { size_t pos, len; };
+
+static size_t digit_reader_read(void *ctx, char *buf, size_t len) {
+  struct digit_reader *dr = ctx;
+  size_t n = 0;
+  while (n < len && dr->pos < dr->len) { buf[n++] = '0' + dr->pos++ % 10; }
+  return n;
+}
+
+static size_t digit_reader_size(void *ctx) {
+  return ((struct digit_reader *)ctx)->len;
+}
+
+/* Custom conversions, for testing registration. */
+static bool print_order_id(struct conv *restrict conv,
+                           struct printer *restrict p) {
+  (void)p;
+  char buf[24];
+  const int len = simple_snprintf(buf, sizeof(buf), "ORD-%08u",
+                                  va_arg(*conv->args, unsigned));
+  return print_converted_string(conv, buf, len);
+}
+
+static bool print_price_ticks(struct conv *restrict conv,
+                              struct printer *restrict p) {
+  (void)p;
+  const long ticks = va_arg(*conv->args, long);  /* In hundredths. */
+  const unsigned long mag = ticks < 0 ? -(unsigned long)ticks
+                                      : (unsigned long)ticks;
+  char buf[32];
+  const int len = simple_snprintf(buf, sizeof(buf), "%s%lu.%02lu",
+                                  ticks < 0 ? "-" : "", mag / 100, mag % 100);
+  return print_converted_string(conv, buf, len);
+}
+
+int main() {
+  simple_printf("Hello %s, the answer is %d.\n", "world", 42);
+  simple_printf("Zero: %d %i %o %x %X char: '%c'\n", 0, 0, 0, 0, 0, '*');
+
+  simple_printf("\nIntegers: signed char / unsigned char\n");
+  simple_printf("Positive %%hhd %%#hhd: %hhd %#hhd\n", 123456789,  123456789);
+  simple_printf("Negative %%hhd %%#hhd: %hhd %#hhd\n", -123456789, -123456789);
+  simple_printf("Positive %%hhi %%#hhi: %hhi %#hhi\n", 123456789,  123456789);
+  simple_printf("Negative %%hhi %%#hhi: %hhi %#hhi\n", -123456789, -123456789);
+  simple_printf("Unsigned %%hhu %%#hhu: %hhu %#hhu\n", 4000000000U,4000000000U);
+  simple_printf("Octal    %%hho %%#hho: %hho %#hho\n", 123456789,  123456789);
+  simple_printf("Octal    %%hho %%#hho: %hho %#hho\n", -123456789, -123456789);
+  simple_printf("Octal    %%hho %%#hho: %hho %#hho\n", 4000000000U,4000000000U);
+  simple_printf("Hex      %%hhx %%#hhx: %hhx %#hhx\n", 123456789,  123456789);
+  simple_printf("Hex      %%hhx %%#hhx: %hhx %#hhx\n", -123456789, -123456789);
+  simple_printf("Hex      %%hhx %%#hhx: %hhx %#hhx\n", 4000000000U,4000000000U);
+  simple_printf("Hex      %%hhX %%#hhX: %hhX %#hhX\n", 123456789,  123456789);
+  simple_printf("Hex      %%hhX %%#hhX: %hhX %#hhX\n", -123456789, -123456789);
+  simple_printf("Hex      %%hhX %%#hhX: %hhX %#hhX\n", 4000000000U,4000000000U);
+
+  simple_printf("\nIntegers: short / unsigned short\n");
+  simple_printf("Positive %%hd %%#hd: %hd %#hd\n", 123456789,  123456789);
+  simple_printf("Negative %%hd %%#hd: %hd %#hd\n", -123456789, -123456789);
+  simple_printf("Positive %%hi %%#hi: %hi %#hi\n", 123456789,  123456789);
+  simple_printf("Negative %%hi %%#hi: %hi %#hi\n", -123456789, -123456789);
+  simple_printf("Unsigned %%hu %%#hu: %hu %#hu\n", 4000000000U,4000000000U);
+  simple_printf("Octal    %%ho %%#ho: %ho %#ho\n", 123456789,  123456789);
+  simple_printf("Octal    %%ho %%#ho: %ho %#ho\n", -123456789, -123456789);
+  simple_printf("Octal    %%ho %%#ho: %ho %#ho\n", 4000000000U,4000000000U);
+  simple_printf("Hex      %%hx %%#hx: %hx %#hx\n", 123456789,  123456789);
+  simple_printf("Hex      %%hx %%#hx: %hx %#hx\n", -123456789, -123456789);
+  simple_printf("Hex      %%hx %%#hx: %hx %#hx\n", 4000000000U,4000000000U);
+  simple_printf("Hex      %%hX %%#hX: %hX %#hX\n", 123456789,  123456789);
+  simple_printf("Hex      %%hX %%#hX: %hX %#hX\n", -123456789, -123456789);
+  simple_printf("Hex      %%hX %%#hX: %hX %#hX\n", 4000000000U,4000000000U);
+
+  simple_printf("\nIntegers: int / unsigned int\n");
+  simple_printf("Positive %%d %%#d: %d %#d\n", 123456789,  123456789);
+  simple_printf("Negative %%d %%#d: %d %#d\n", -123456789, -123456789);
+  simple_printf("Positive %%i %%#i: %i %#i\n", 123456789,  123456789);
+  simple_printf("Negative %%i %%#i: %i %#i\n", -123456789, -123456789);
+  simple_printf("Unsigned %%u %%#u: %u %#u\n", 4000000000U,4000000000U);
+  simple_printf("Octal    %%o %%#o: %o %#o\n", 123456789,  123456789);
+  simple_printf("Octal    %%o %%#o: %o %#o\n", -123456789, -123456789);
+  simple_printf("Octal    %%o %%#o: %o %#o\n", 4000000000U,4000000000U);
+  simple_printf("Hex      %%x %%#x: %x %#x\n", 123456789,  123456789);
+  simple_printf("Hex      %%x %%#x: %x %#x\n", -123456789, -123456789);
+  simple_printf("Hex      %%x %%#x: %x %#x\n", 4000000000U,4000000000U);
+  simple_printf("Hex      %%X %%#X: %X %#X\n", 123456789,  123456789);
+  simple_printf("Hex      %%X %%#X: %X %#X\n", -123456789, -123456789);
+  simple_printf("Hex      %%X %%#X: %X %#X\n", 4000000000U,4000000000U);
+
+  simple_printf("\nIntegers: long / unsigned long\n");
+  simple_printf("Positive %%ld %%#ld: %ld %#ld\n", 123456789,  123456789);
+  simple_printf("Negative %%ld %%#ld: %ld %#ld\n", -123456789, -123456789);
+  simple_printf("Positive %%li %%#li: %li %#li\n", 123456789,  123456789);
+  simple_printf("Negative %%li %%#li: %li %#li\n", -123456789, -123456789);
+  simple_printf("Unsigned %%lu %%#lu: %lu %#lu\n", 4000000000U,4000000000U);
+  simple_printf("Octal    %%lx %%#lx: %lo %#lo\n", 123456789,  123456789);
+  simple_printf("Octal    %%lx %%#lx: %lo %#lo\n", -123456789, -123456789);
+  simple_printf("Octal    %%lx %%#lx: %lo %#lo\n", 4000000000U,4000000000U);
+  simple_printf("Hex      %%lx %%#lx: %lx %#lx\n", 123456789,  123456789);
+  simple_printf("Hex      %%lx %%#lx: %lx %#lx\n", -123456789, -123456789);
+  simple_printf("Hex      %%lx %%#lx: %lx %#lx\n", 4000000000U,4000000000U);
+  simple_printf("Hex      %%lX %%#lX: %lX %#lX\n", 123456789,  123456789);
+  simple_printf("Hex      %%lX %%#lX: %lX %#lX\n", -123456789, -123456789);
+  simple_printf("Hex      %%lX %%#lX: %lX %#lX\n", 4000000000U,4000000000U);
+
+  simple_printf("\nIntegers: long long / unsigned long long\n");
+  simple_printf("Positive %%lld %%#lld: %lld %#lld\n", 123456789123456789LL,
+                                                       123456789123456789LL);
+  simple_printf("Negative %%lld %%#lld: %lld %#lld\n", -123456789123456789LL,
+                                                       -123456789123456789LL);
+  simple_printf("Positive %%lli %%#lli: %lli %#lli\n", 123456789123456789LL,
+                                                       123456789123456789LL);
+  simple_printf("Negative %%lli %%#lli: %lli %#lli\n", -123456789123456789LL,
+                                                       -123456789123456789LL);
+  simple_printf("Unsigned %%llu %%#llu: %llu %#llu\n", 4000000000000000000ULL,
+                                                       4000000000000000000ULL);
+  simple_printf("Octal    %%llo %%#llo: %llo %#llo\n", 123456789123456789LL,
+                                                       123456789123456789LL);
+  simple_printf("Octal    %%llo %%#llo: %llo %#llo\n", -123456789123456789LL,
+                                                       -123456789123456789LL);
+  simple_printf("Octal    %%llo %%#llo: %llo %#llo\n", 4000000000000000000ULL,
+                                                       4000000000000000000ULL);
+  simple_printf("Hex      %%llx %%#llx: %llx %#llx\n", 123456789123456789LL,
+                                                       123456789123456789LL);
+  simple_printf("Hex      %%llx %%#llx: %llx %#llx\n", -123456789123456789LL,
+                                                       -123456789123456789LL);
+  simple_printf("Hex      %%llx %%#llx: %llx %#llx\n", 4000000000000000000ULL,
+                                                       4000000000000000000ULL);
+  simple_printf("Hex      %%llX %%#llX: %llX %#llX\n", 123456789123456789LL,
+                                                       123456789123456789LL);
+  simple_printf("Hex      %%llX %%#llX: %llX %#llX\n", -123456789123456789LL,
+                                                       -123456789123456789LL);
+  simple_printf("Hex      %%llX %%#llX: %llX %#llX\n", 4000000000000000000ULL,
+                                                       4000000000000000000ULL);
+
+  simple_printf("\nIntegers: size_t\n");
+  simple_printf("Positive %%zd: %jd  (expected: -1)\n", SIZE_MAX);
+  simple_printf("Unsigned %%zu: %ju\n", SIZE_MAX);
+  simple_printf("Octal    %%zo: %jo\n", SIZE_MAX);
+  simple_printf("Hex      %%zx: %jx\n", SIZE_MAX);
+  simple_printf("Hex      %%zX: %jX\n", SIZE_MAX);
+
+  simple_printf("\nIntegers: ptrdiff_t\n");
+  simple_printf("Positive %%td: %jd\n", PTRDIFF_MAX);
+  simple_printf("Negative %%td: %jd\n", PTRDIFF_MIN);
+  simple_printf("Unsigned %%tu: %ju\n", PTRDIFF_MAX);
+  simple_printf("Octal    %%to: %jo\n", PTRDIFF_MAX);
+  simple_printf("Hex      %%tx: %jx\n", PTRDIFF_MAX);
+  simple_printf("Hex      %%tX: %jX\n", PTRDIFF_MAX);
+
+  simple_printf("\nIntegers: intmax_t / uintmax_t\n");
+  simple_printf("Positive %%jd: %jd\n", INTMAX_MAX);
+  simple_printf("Negative %%jd: %jd\n", INTMAX_MIN);
+  simple_printf("Unsigned %%ju: %ju\n", UINTMAX_MAX);
+  simple_printf("Octal    %%jo: %jo\n", UINTMAX_MAX);
+  simple_printf("Hex      %%jx: %jx\n", UINTMAX_MAX);
+  simple_printf("Hex      %%jX: %jX\n", UINTMAX_MAX);
+
+  simple_printf("Positive %%#jd: %#jd\n", INTMAX_MAX);
+  simple_printf("Negative %%#jd: %#jd\n", INTMAX_MIN);
+  simple_printf("Unsigned %%#ju: %#ju\n", UINTMAX_MAX);
+  simple_printf("Octal    %%#jo: %#jo\n", UINTMAX_MAX);
+  simple_printf("Hex      %%#jx: %#jx\n", UINTMAX_MAX);
+  simple_printf("Hex      %%#jX: %#jX\n", UINTMAX_MAX);
+
+  simple_printf("\nField width & precision:\n");
+  simple_printf("%%c:    [%c]        %%-10c:    [%-10c] %%10c:    [%10c]\n",
+                '*', '*', '*');
+  simple_printf("%%s:    [%s]    %%-10s:    [%-10s] %%10s:    [%10s]\n",
+                "Hello", "Hello", "Hello");
+  simple_printf("%%.2s:  [%.2s]       %%-10.2s:  [%-10.2s] %%10.2s:  "
+                "[%10.2s]\n", "Hello", "Hello", "Hello");
+  simple_printf("%%d:    [%d]    %%-10d:    [%-10d] %%10d:    [%10d]\n",
+                12345, 12345, 12345);
+  simple_printf("%%d:    [%d]    %%-10d:    [%-10d] %%10d:    [%10d]\n",
+                -1234, -1234, -1234);
+
+  simple_printf("%% d:   [% d]    %% -10d:   [% -10d] %% 10d:   [% 10d]\n",
+                1234, 1234, 1234);
+  simple_printf("%% d:   [% d]    %% -10d:   [% -10d] %% 10d:   [% 10d]\n",
+                -1234, -1234, -1234);
+  simple_printf("%%+d:   [%+d]    %%+-10d:   [%+-10d] %%+10d:   [%+10d]\n",
+                1234, 1234, 1234);
+  simple_printf("%%+d:   [%+d]    %%+-10d:   [%+-10d] %%+10d:   [%+10d]\n",
+                -1234, -1234, -1234);
+
+  simple_printf("%% .7d: [% .7d] %% -10.7d: [% -10.7d] %% 10.7d: [% 10.7d]\n",
+                1234, 1234, 1234);
+  simple_printf("%% .7d: [% .7d] %% -10.7d: [% -10.7d] %% 10.7d: [% 10.7d]\n",
+                -1234, -1234, -1234);
+  simple_printf("%%+.7d: [%+.7d] %%+-10.7d: [%+-10.7d] %%+10.7d: [%+10.7d]\n",
+                1234, 1234, 1234);
+  simple_printf("%%+.7d: [%+.7d] %%+-10.7d: [%+-10.7d] %%+10.7d: [%+10.7d]\n",
+                -1234, -1234, -1234);
+
+  simple_printf("%%07d:  [%07d]  %%-07d:    [%-07d]    %%07d:    [%07d]\n",
+                1234, 1234, 1234);
+  simple_printf("%%07d:  [%07d]  %%-07d:    [%-07d]    %%07d:    [%07d]\n",
+                -1234, -1234, -1234);
+  simple_printf("%% 07d: [% 07d]  %% -07d:   [% -07d]    %% 07d:   [% 07d]\n",
+                1234, 1234, 1234);
+  simple_printf("%% 07d: [% 07d]  %% -07d:   [% -07d]    %% 07d:   [% 07d]\n",
+                -1234, -1234, -1234);
+  simple_printf("%%+07d: [%+07d]  %%+-07d:   [%+-07d]    %%+07d:   [%+07d]\n",
+                1234, 1234, 1234);
+  simple_printf("%%+07d: [%+07d]  %%+-07d:   [%+-07d]    %%+07d:   [%+07d]\n",
+                -1234, -1234, -1234);
+
+  simple_printf("\nWidth from '*', string \"x\":\n");
+  for (int i = -10; i <= 10; ++i) {
+    simple_printf("%%*s, * == %+3d:  [%*s]\n", i, i, "x");
+  }
+
+  simple_printf("\nPrecision from '*', string \"01234567\":\n");
+  for (int i = -10; i <= 10; ++i) {
+    simple_printf("%%.*s, * == %+3d:  [%.*s]\n", i, i, "01234567");
+  }
+
+  simple_printf("\nZero precision zeros should print nothing: "
+                "[%%.d%%.i%%.u%%.o%%.x%%.X] -> [%.d%.i%.u%.o%.x%.X]\n",
+                 0, 0, 0, 0, 0, 0);
+  simple_printf("Zero width zeros should print something: "
+                "[%%*d%%*i%%*u%%*o%%*x%%*X] -> \[%*d%*i%*u%*o%*x%*X]\n",
+                0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  simple_printf("Zeros past the buffer: [%%070d] -> [%070d]\n", -42);
+  simple_printf("Zeros past the buffer: [%%#.64x] -> [%#.64x]\n", 0xbeefu);
+  {
+    char buf[16];
+    simple_printf("Zeros past the buffer: [%%*.40000d] -> %d bytes\n",
+                  simple_snprintf(buf, sizeof(buf), "%*.40000d", 40010, 7));
+  }
+
+  int x;
+  simple_printf("Pointer: (void *)&x = %p\n", (void *)&x);
+
+  simple_printf("\nsimple_snprintf with various size buffers:\n");
+  for (int i = 50; i >= 0; i -= 5) {
+    char buf[50];
+    x = simple_snprintf(buf, i, "This is a test: %.16llX%.16llX",
+                        0xDEADBEEFDEADBEEFULL, 0xABCDABCDABCDABCDULL);
+    simple_printf("x=%d, buf=[%s]\n", x, buf);
+  }
+
+  simple_printf("\nWide characters and strings, as UTF-8:\n");
+  simple_printf("%%lc:   [%lc] [%lc] [%lc] [%lc]\n",
+                (wint_t)L'A', (wint_t)0xE9, (wint_t)0x20AC, (wint_t)0x1F600);
+  simple_printf("%%ls:   [%ls]\n", L"Wide ASCII, long enough for fast path.");
+  simple_printf("%%ls:   [%ls]\n", L"caf\u00E9 \u20AC5 \U0001F600");
+  simple_printf("%%10ls: [%10ls] %%-10ls: [%-10ls]\n", L"\u00E9t\u00E9",
+                L"\u00E9t\u00E9");
+  simple_printf("Precision in bytes, whole characters only:\n");
+  for (int i = 0; i <= 7; ++i) {
+    simple_printf("%%.*ls, * == %d:  [%.*ls]\n", i, i, L"\u20AC\u20AC$");
+  }
+
+  simple_printf("\nUTF-8 widths and precisions, in chars with \"'\":\n");
+  simple_printf("%%8s:   [%8s] [%8s]\n", "Zo\u00eb", "Zoe");
+  simple_printf("%%'8s:  [%'8s] [%'8s]\n", "Zo\u00eb", "Zoe");
+  simple_printf("%%'-8s: [%'-8s] [%'-8s]\n", "Zo\u00eb", "Zoe");
+  simple_printf("%%'3c:  [%'3c] [%'3lc]\n", 'x', (wint_t)0x20AC);
+  for (int i = 0; i <= 12; i += 3) {
+    simple_printf("%%'.*s, * == %2d:  [%'.*s]\n", i, i,
+                  "\u20ac1 na\u00efve r\u00e9sum\u00e9");
+  }
+
+  simple_printf("\nString slices, with a size_t length:\n");
+  simple_printf("%%zs:    [%zs] [%zs]\n", (size_t)5, "Hello, world", (size_t)0,
+                "ignored");
+  simple_printf("%%-8zs:  [%-8zs] %%8zs: [%8zs] %%.2zs: [%.2zs]\n",
+                (size_t)3, "abcdef", (size_t)3, "abcdef", (size_t)3, "abcdef");
+
+  simple_printf("\nScatter/gather strings from struct iovec:\n");
+  struct iovec iov[3] = {
+    { .iov_base = "Hello", .iov_len = 5 },
+    { .iov_base = "",      .iov_len = 0 },
+    { .iov_base = ", rope!", .iov_len = 7 },
+  };
+  simple_printf("%%V:     [%V]\n", iov, 3);
+  simple_printf("%%16V:   [%16V] %%-16V: [%-16V]\n", iov, 3, iov, 3);
+  simple_printf("%%.7V:   [%.7V] %%.0V: [%.0V]\n", iov, 3, iov, 3);
+
+  simple_printf("\nStreamed strings from struct simple_reader:\n");
+  struct digit_reader dr = { 0, 12 };
+  struct simple_reader rd = { digit_reader_read, digit_reader_size, &dr };
+  simple_printf("%%R:     [%R]\n", &rd);
+  dr.pos = 0;  simple_printf("%%16R:   [%16R]\n", &rd);
+  dr.pos = 0;  simple_printf("%%-16R:  [%-16R]\n", &rd);
+  dr.pos = 0;  simple_printf("%%10.5R: [%10.5R]\n", &rd);
+  dr.pos = 0;  dr.len = 600;
+  char rd_buf[20];
+  x = simple_snprintf(rd_buf, sizeof(rd_buf), "%R", &rd);
+  simple_printf("%%R, 600 digits: x=%d, buf=[%s]\n", x, rd_buf);
+
+  simple_printf("\nJSON-escaped strings:\n");
+  const char *json_str = "Say \"hi\"\tto C:\\temp\n\x01 and caf\u00e9.";
+  simple_printf("%%J:     [%J]\n", json_str);
+  simple_printf("%%#J:    [%#J]\n", json_str);
+  simple_printf("%%#zJ:   [%#zJ]\n", (size_t)3, "a\0b");
+  simple_printf("%%#12J:  [%#12J] %%-12J: [%-12J]\n", "a\"b", "a\"b");
+  for (int i = 0; i <= 8; i += 2) {
+    simple_printf("%%#.*J, * == %d: [%#.*J]\n", i, i, "\"\"\"\"");
+  }
+
+  simple_printf("\nQuoted strings for C and the shell:\n");
+  const char *quote_str = "It's a \"trap\"\n\a\x7f\xff!";
+  simple_printf("%%q:     [%q]\n", quote_str);
+  simple_printf("%%q:     [%q]\n", "\x01" "a\x1b" "7");
+  simple_printf("%%#q:    [%#q]\n", quote_str);
+  simple_printf("%%#q:    [%#q] [%#12q] [%#.4q]\n",
+                "log\nINFO forged\r", "it's", "a\tb");
+  simple_printf("%%-8q:   [%-8q] %%8.6q: [%8.6q]\n", "\t", "\t\t\t\t");
+
+  simple_printf("\nCSV and TSV fields:\n");
+  simple_printf("%%Q:     %Q,%Q,%Q,%Q\n", "plain", "a,b", "say \"hi\"",
+                "two\nlines");
+  simple_printf("%%#Q:    %#Q\t%#Q\t%#Q\n", "plain", "a\tb", "C:\\x\ny");
+  simple_printf("%%8Q:    [%8Q] [%-8Q]\n", "a,b", "a,b");
+  simple_printf("%%.6Q:   [%.6Q] %%.4zQ: [%.4zQ]\n",
+                "say \"hi\"", (size_t)7, "a,\"b\",c");
+
+  simple_printf("\nURL percent-encoding:\n");
+  const char *url_str = "a b&c=d/\u00e9~";
+  simple_printf("%%U:     [%U]\n", url_str);
+  simple_printf("%%#U:    [%#U]\n", url_str);
+  simple_printf("%%.3U:   [%.3U] %%12U: [%12U] %%-12U: [%-12U]\n",
+                url_str, "a b", "a b");
+  const char unterminated[4] = { 'a', ' ', 'b', '"' };  /* No null. */
+  simple_printf("%%.4U, %%.4J, %%.4q, %%.4Q of char[4]: [%.4U] [%.4J] [%.4q] "
+                "[%.4Q]\n", unterminated, unterminated, unterminated,
+                unterminated);
+
+  simple_printf("\nHex dumps:\n");
+  const char hex_str[] = "Hello, world!\n\x00\x01\x7f\xff and more bytes.";
+  simple_printf("%%r:     [%r]\n", "\x01\x23\xab\xcd\xef", (size_t)5);
+  simple_printf("%% r:    [% r]\n", "\x01\x23\xab\xcd\xef", (size_t)5);
+  simple_printf("%% .2r:  [% .2r]\n", "\x01\x23\xab\xcd\xef", (size_t)5);
+  simple_printf("%%12r:   [%12r] %%-12r: [%-12r]\n", "\xde\xad", (size_t)2,
+                "\xbe\xef", (size_t)2);
+  simple_printf("%%#r:\n%#r", hex_str, sizeof(hex_str) - 1);
+  simple_printf("%%#.4r:\n%#.4r", hex_str, (size_t)20);
+
+  simple_printf("\nBase64 and base32:\n");
+  for (size_t i = 0; i <= 6; i++) {
+    simple_printf("\"%.*s\": [%Y] [%+Y] [%y] [%+#y]\n", (int)i, "foobar",
+                  "foobar", i, "foobar", i, "foobar", i, "foobar", i);
+  }
+  simple_printf("%%#Y:    [%#Y] [%Y]\n", "\xfb\xff", (size_t)2,
+                "\xfb\xff", (size_t)2);
+  simple_printf("%%10.3Y: [%10.3Y] %%-10Y: [%-10Y]\n", "foobar", (size_t)6,
+                "foo", (size_t)3);
+
+  simple_printf("\nTimestamps:\n");
+  struct timespec ts = { .tv_sec = 1689856496, .tv_nsec = 123456789 };
+  simple_printf("%%T:     [%T]\n", &ts);
+  simple_printf("%%#.3T:  [%#.3T] %%.0T: [%.0T] %%.9T: [%.9T]\n",
+                &ts, &ts, &ts);
+  simple_printf("%%jT:    [%jT] [%jT]\n", (intmax_t)0, (intmax_t)-1);
+  simple_printf("%%jT:    [%jT]\n", (intmax_t)951782400 * 1000000000);
+  simple_printf("%%32T:   [%32T]\n", &ts);
+
+  simple_printf("\nHumanized durations and sizes:\n");
+  const uint64_t durations[] = {
+    0, 999, 1234, 1234567, 12345678, 999950000, 999949999, 3600000000000
+  };
+  for (size_t i = 0; i < sizeof(durations) / sizeof(durations[0]); i++) {
+    simple_printf("%%N:  %-14llu -> [%N] [%.2N] [%8N]\n",
+                  (unsigned long long)durations[i], durations[i],
+                  durations[i], durations[i]);
+  }
+  const uint64_t sizes[] = {
+    0, 512, 1023, 1024, 1536, 1048064, 16320875724, UINT64_MAX
+  };
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    simple_printf("%%K:  %-20llu -> [%K] [%#K] [%-10.4K]\n",
+                  (unsigned long long)sizes[i], sizes[i], sizes[i], sizes[i]);
+  }
+  simple_printf("%%.60K: [%.60K] %%.25N: [%.25N]\n",
+                (uint64_t)1536, (uint64_t)1234567);
+  simple_printf("%%.19N: [%.19N] %%#.99K: [%#.99K]\n",
+                (uint64_t)UINT64_MAX, (uint64_t)UINT64_MAX);
+
+  simple_printf("\nNetwork addresses and IDs:\n");
+  const unsigned char ipv4[4] = { 192, 0, 2, 1 };
+  simple_printf("%%I:     [%I] [%-16I] [%16I]\n", ipv4, ipv4, ipv4);
+  const unsigned char ipv6[][16] = {
+    { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 },
+    { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1 },
+    { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1 },
+    { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1 },
+    { 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 192, 0, 2, 1 },
+    { 0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0x0a, 0xbc, 0, 0, 0, 0, 0x12, 0x34 },
+  };
+  for (size_t i = 0; i < sizeof(ipv6) / sizeof(ipv6[0]); i++) {
+    simple_printf("%%lI:    [%lI]\n", ipv6[i]);
+  }
+  const unsigned char mac[6] = { 0x00, 0x1a, 0x2b, 0x3c, 0x4d, 0x5e };
+  simple_printf("%%M:     [%M]\n", mac);
+  const unsigned char uuid[16] = {
+    0x12, 0x3e, 0x45, 0x67, 0xe8, 0x9b, 0x12, 0xd3,
+    0xa4, 0x56, 0x42, 0x66, 0x14, 0x17, 0x40, 0x00
+  };
+  simple_printf("%%W:     [%W]\n", uuid);
+
+  simple_printf("\nerrno messages and names:\n");
+  const int errnums[] = { 0, ENOENT, EAGAIN, EINVAL, 12345 };
+  for (size_t i = 0; i < sizeof(errnums) / sizeof(errnums[0]); i++) {
+    errno = errnums[i];
+    simple_printf("errno=%-5d %%m: [%m] %%#m: [%#m] %%-8.4m: [%-8.4m]\n",
+                  errnums[i]);
+  }
+
+  simple_printf("\nProcess and thread identity:\n");
+  simple_printf("%%P: [%P] (getpid() = %d)\n", (int)getpid());
+  simple_printf("%%lP: [%lP]\n");
+  simple_printf_set_thread_name("demo-main");
+  simple_printf("%%#P: [%#P] %%-12#P: [%#-12P]\n");
+
+  simple_printf("\nCustom conversions:\n");
+  const int reg_k = simple_printf_register_conversion('k', print_order_id);
+  const int reg_k2 = simple_printf_register_conversion('k', print_order_id);
+  const int reg_d = simple_printf_register_conversion('d', print_order_id);
+  const int reg_p = simple_printf_register_named("price", print_price_ticks);
+  const int reg_p2 = simple_printf_register_named("price", print_price_ticks);
+  simple_printf("register k: %d, again: %d, d: %d, {price}: %d, again: %d\n",
+                reg_k, reg_k2, reg_d, reg_p, reg_p2);
+  simple_printf_freeze_conversions();
+  simple_printf("frozen: %d\n",
+                simple_printf_register_conversion('v', print_order_id));
+  simple_printf("%%k: [%k] %%-14k: [%-14k]\n", 42u, 7u);
+  simple_printf("%%{price}: [%{price}] %%10{price}: [%10{price}]\n",
+                12345L, -5L);
+  simple_printf("Unknown: [%{cost}] [%{price] [%v]\n");
+
+  simple_printf("\nRepeated characters:\n");
+  simple_printf("+%*=+%*=+\n", 10, '-', 6, '-');
+  simple_printf("|%-10s|%6d|\n", "widgets", 42);
+  simple_printf("+%10=+%6=+\n", '=', '=');
+  simple_printf("%%l=: [%*l=] %%=: [%0=] [%3=]\n",
+                12, (wint_t)0x2500, 'x', 'x');
+  {
+    char buf[16];
+    const int len = simple_snprintf(buf, sizeof(buf), "%10000=", '#');
+    simple_printf("%%10000= into 16 bytes: %d [%s]\n", len, buf);
+    simple_printf("%%*= and %%*l=, * == 40000 into 16 bytes: %d %d\n",
+                  simple_snprintf(buf, sizeof(buf), "%*=", 40000, '#'),
+                  simple_snprintf(buf, sizeof(buf), "%*l=", 40000,
+                                  (wint_t)0x2500));
+    simple_printf("%%*=, * == -5: [%*=]\n", -5, '#');
+  }
+
+  simple_printf("\nWidths past 32767, as lengths from snprintf and fprintf:\n");
+  {
+    char buf[16];
+    FILE *const f = tmpfile();
+    if (f) {
+      simple_printf("%%*s:    %d %d\n",
+                    simple_snprintf(buf, sizeof(buf), "%*s|", 40000, "x"),
+                    simple_fprintf(f, "%*s|", 40000, "x"));
+      simple_printf("%%-*s:   %d %d\n",
+                    simple_snprintf(buf, sizeof(buf), "%-*s|", 40000, "x"),
+                    simple_fprintf(f, "%-*s|", 40000, "x"));
+      simple_printf("%%-*zs:  %d %d\n",
+                    simple_snprintf(buf, sizeof(buf), "%-*zs|", 40000,
+                                    (size_t)1, "x"),
+                    simple_fprintf(f, "%-*zs|", 40000, (size_t)1, "x"));
+      simple_printf("%%*V:    %d %d\n",
+                    simple_snprintf(buf, sizeof(buf), "%*V|", 40000, iov, 3),
+                    simple_fprintf(f, "%-*V|", 40000, iov, 3));
+      dr.pos = 0;
+      const int r_len = simple_snprintf(buf, sizeof(buf), "%*R|", 40000, &rd);
+      dr.pos = 0;
+      simple_printf("%%*R:    %d %d\n",
+                    r_len, simple_fprintf(f, "%-*R|", 40000, &rd));
+      simple_printf("%%*r:    %d %d\n",
+                    simple_snprintf(buf, sizeof(buf), "%*r|", 40000,
+                                    "\xab", (size_t)1),
+                    simple_fprintf(f, "%-*r|", 40000, "\xab", (size_t)1));
+      simple_printf("%%*Y:    %d %d\n",
+                    simple_snprintf(buf, sizeof(buf), "%*Y|", 40000,
+                                    "foo", (size_t)3),
+                    simple_fprintf(f, "%-*y|", 40000, "foo", (size_t)3));
+      simple_printf("%%*J:    %d %d\n",
+                    simple_snprintf(buf, sizeof(buf), "%*J|", 40000, "\""),
+                    simple_fprintf(f, "%#-*J|", 40000, "\""));
+      simple_printf("%%*ls:   %d %d\n",
+                    simple_snprintf(buf, sizeof(buf), "%*ls|", 40000, L"x"),
+                    simple_fprintf(f, "%-*ls|", 40000, L"x"));
+      fclose(f);
+    }
+  }
+
+  simple_printf("\nTesting %%n with different widths.\n");
+  char       hh0 = -99,   hh1 = -99;
+  short      h0  = -9999, h1  = -9999;
+  int        i0  = -9999, i1  = -9999;
+  long       l0  = -9999, l1  = -9999;
+  long long  ll0 = -9999, ll1 = -9999;
+  intmax_t   j0  = -9999, j1  = -9999;
+  ssize_type z0  = -9999, z1  = -9999;
+  ptrdiff_t  t0  = -9999, t1  = -9999;
+
+  simple_printf(
+      "ABCDE%hhn%hn%n%ln%lln%jn%zn%tnFGHIJ%hhn%hn%n%ln%lln%jn%zn%tn\n",
+      &hh0, &h0, &i0, &l0, &ll0, &j0, &z0, &t0,  /* all should be 5 */
+      &hh1, &h1, &i1, &l1, &ll1, &j1, &z1, &t1); /* all should be 10 */
+  simple_printf(
+      "hh0=%d, h0=%d, i0=%d, l0=%ld, ll0=%lld, j0=%jd, z0=%zd, t0=%td\n",
+      hh0, h0, i0, l0, ll0, j0, z0, t0);
+  simple_printf(
+      "hh1=%d, h1=%d, i1=%d, l1=%ld, ll1=%lld, j1=%jd, z1=%zd, t1=%td\n",
+      hh1, h1, i1, l1, ll1, j1, z1, t1);
+}